@@ -0,0 +1,40 @@
+#!/bin/bash
+#--------------------------------------------------------------------------------------------------
+# Network Lab                             Spring 2024                           System Programming
+#
+# bench/backends.sh
+#
+# Compare the connection throughput of the mcdonalds server backends (thread, uring).
+# Each backend is started in turn and driven by ./client with an increasing number of concurrent
+# customers. Customers that are not served, mostly connections rejected because CUSTOMER_MAX
+# customers are already in the server, are counted in their own column and do not count towards
+# the connection rate. The default sweep stays within CUSTOMER_MAX (10).
+#
+# usage: bench/backends.sh [customers...]      (default: 1 5 10)
+#
+
+cd "$(dirname "$0")/.." || exit 1
+make -s mcdonalds client || exit 1
+
+CUSTOMERS=${@:-1 5 10}
+BACKENDS="thread uring"
+
+printf "%-8s %10s %10s %10s %10s %12s\n" backend customers served rejected wall_s conn_per_s
+for b in $BACKENDS; do
+  for n in $CUSTOMERS; do
+    ./mcdonalds -b $b > /dev/null 2>&1 &
+    srv=$!
+    sleep 0.5
+
+    start=$(date +%s.%N)
+    served=$(./client $n 2>/dev/null | grep -c "Goodbye")
+    end=$(date +%s.%N)
+
+    kill -INT $srv; sleep 0.2; kill -INT $srv 2>/dev/null
+    wait $srv 2>/dev/null
+
+    awk -v b=$b -v n=$n -v s=$served -v t0=$start -v t1=$end \
+      'BEGIN { t = t1 - t0
+               printf "%-8s %10d %10d %10d %10.3f %12.1f\n", b, n, s, n - s, t, s / t }'
+  done
+done
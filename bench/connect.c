@@ -0,0 +1,159 @@
+//--------------------------------------------------------------------------------------------------
+// Network Lab                             Spring 2024                           System Programming
+//
+/// @file  bench/connect.c
+/// @brief connections per second over TCP loopback for each connection-setup option
+///
+/// @section changelog Change Log
+/// 2026/10/18 ARC lab created
+///
+/// @section license_section License
+/// Copyright (c) 2024-2026, Architecture and Code Optimization Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS  BE LIABLE FOR ANY DIRECT,  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY,  OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS; OR BUSINESS INTERRUPTION)  HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "net.h"
+#include "burger.h"
+#include "bench.h"
+
+#define CLIENTS     4                                       ///< concurrent connecting threads
+#define CONNECTIONS 2000                                    ///< connections per client thread
+#define DEFERRED    2                                       ///< connections per client with defer
+
+static const char welcome_line[] = "Welcome to McDonald's, customer #1\n";
+static const char order_line[] = "bigmac cheese chicken\n";
+static const char goodbye_line[] = "Your order(bigmac cheese chicken) is ready! Goodbye!\n";
+
+/// @brief one connection-setup configuration
+struct config {
+  const char *name;                                         ///< CSV parameter column
+  struct net_options opt;                                   ///< listening/connecting socket tuning
+  int accept4;                                              ///< use accept4(SOCK_CLOEXEC)
+  int connections;                                          ///< connections per client thread
+};
+
+// each configuration adds one option to the previous one
+static const struct config configs[] = {
+  { "plain",    { 32,        0, 0, 0  }, 0, CONNECTIONS },
+  { "accept4",  { 32,        0, 0, 0  }, 1, CONNECTIONS },
+  { "backlog",  { SOMAXCONN, 0, 0, 0  }, 1, CONNECTIONS },
+  { "nodelay",  { SOMAXCONN, 1, 0, 0  }, 1, CONNECTIONS },
+  { "fastopen", { SOMAXCONN, 1, 0, 16 }, 1, CONNECTIONS },
+  // the server speaks first, so deferred accepts only complete on the defer timeout
+  { "defer",    { SOMAXCONN, 1, 1, 0  }, 1, DEFERRED },
+};
+
+/// @brief benchmark state shared by the server and the client threads
+struct run {
+  const struct config *cfg;                                 ///< configuration under test
+  unsigned short port;                                      ///< listening port
+  int listenfd;                                             ///< listening socket
+  unsigned long served;                                     ///< completed connections (server)
+};
+
+/// @brief server side: welcome, read the order, reply, close; one connection at a time
+static void* server_task(void *data)
+{
+  struct run *r = (struct run *)data;
+  size_t buflen = BUF_INITIAL;
+  char *buffer = buf_alloc(&buflen);
+  int total = CLIENTS * r->cfg->connections;
+  int fd, i;
+
+  for (i = 0; i < total; i++) {
+    if (r->cfg->accept4) fd = accept4(r->listenfd, NULL, NULL, SOCK_CLOEXEC);
+    else fd = accept(r->listenfd, NULL, NULL);
+    if (fd < 0) break;
+
+    put_line(fd, (char *)welcome_line, sizeof(welcome_line));
+    if (get_line(fd, &buffer, &buflen) > 0) {
+      put_line(fd, (char *)goodbye_line, sizeof(goodbye_line));
+      r->served++;
+    }
+    close(fd);
+  }
+
+  buf_free(buffer, buflen);
+  return NULL;
+}
+
+/// @brief client side: run the McDonald's exchange over fresh connections
+static void* client_task(void *data)
+{
+  struct run *r = (struct run *)data;
+  size_t buflen = BUF_INITIAL;
+  char *buffer = buf_alloc(&buflen);
+  int fd, i;
+
+  for (i = 0; i < r->cfg->connections; i++) {
+    fd = open_clientfd_opt(IP, r->port, &r->cfg->opt);
+    if (fd < 0) continue;
+    if (get_line(fd, &buffer, &buflen) > 0) {
+      put_line(fd, (char *)order_line, sizeof(order_line));
+      get_line(fd, &buffer, &buflen);
+    }
+    close(fd);
+  }
+
+  buf_free(buffer, buflen);
+  return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+  pthread_t server, clients[CLIENTS];
+  struct run r;
+  double start;
+  unsigned c;
+  int i;
+
+  bench_header();
+
+  for (c = 0; c < sizeof(configs) / sizeof(configs[0]); c++) {
+    memset(&r, 0, sizeof(r));
+    r.cfg = &configs[c];
+    for (r.port = PORT + 1000; (r.listenfd = open_listenfd_opt(r.port, &r.cfg->opt)) < 0;
+         r.port++);
+
+    start = bench_now();
+    pthread_create(&server, NULL, server_task, &r);
+    for (i = 0; i < CLIENTS; i++) pthread_create(&clients[i], NULL, client_task, &r);
+    for (i = 0; i < CLIENTS; i++) pthread_join(clients[i], NULL);
+    shutdown(r.listenfd, SHUT_RDWR);
+    pthread_join(server, NULL);
+
+    if (r.served > 0) bench_report("connect", r.cfg->name, r.served, bench_now() - start);
+    else printf("connect,%s,0,,\n", r.cfg->name);
+    close(r.listenfd);
+  }
+
+  return EXIT_SUCCESS;
+}
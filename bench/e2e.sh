@@ -0,0 +1,160 @@
+#!/bin/bash
+#--------------------------------------------------------------------------------------------------
+# Network Lab                             Spring 2024                           System Programming
+#
+# bench/e2e.sh
+#
+# End-to-end correctness and throughput regression harness.
+# Launches a server (the built ./mcdonalds or reference/mcdonalds), drives fixed workloads with
+# ./client, verifies that every reply contains exactly the multiset of burgers ordered, and
+# compares throughput and median latency against a stored baseline.
+#
+# usage: bench/e2e.sh [-s built|reference] [-b thread|uring] [-f baseline] [-t threshold] [-u]
+#   -s  server under test (default: built)
+#   -b  backend of the built server (default: thread)
+#   -f  baseline file (default: bench/e2e_baseline.csv)
+#   -t  allowed regression in percent (default: 20)
+#   -u  update the baseline with the results of this run instead of comparing
+#
+# exit status: 0 ok, 1 incorrect replies, 2 performance regression, 3 setup error
+#
+
+cd "$(dirname "$0")/.." || exit 3
+
+SERVER=built
+BACKEND=thread
+BASELINE=bench/e2e_baseline.csv
+THRESHOLD=20
+UPDATE=0
+WORKLOADS="1 5 10"                                  # concurrent customers (<= CUSTOMER_MAX)
+
+while getopts "s:b:f:t:u" opt; do
+  case $opt in
+    s) SERVER=$OPTARG ;;
+    b) BACKEND=$OPTARG ;;
+    f) BASELINE=$OPTARG ;;
+    t) THRESHOLD=$OPTARG ;;
+    u) UPDATE=1 ;;
+    *) sed -n 's/^# usage: /usage: /p' "$0"; exit 3 ;;
+  esac
+done
+
+make -s mcdonalds client || exit 3
+
+TMP=$(mktemp -d)
+trap 'stop_server; rm -rf "$TMP"' EXIT
+
+#--- helpers
+
+# port_free <port>: succeeds if nothing accepts connections on <port>
+port_free() {
+  ! (exec 3<>/dev/tcp/127.0.0.1/$1) 2>/dev/null
+}
+
+# start_server: launch the server under test on a free port and wait until it listens
+start_server() {
+  if [ "$SERVER" = "reference" ]; then
+    # the reference binary always listens on the default port
+    KEY=reference
+    PORT=7777
+    port_free $PORT || { echo "error: port $PORT is in use"; exit 3; }
+    cp reference/mcdonalds "$TMP/mcdonalds" && chmod +x "$TMP/mcdonalds"
+    CMD=("$TMP/mcdonalds")
+  else
+    KEY=built-$BACKEND
+    PORT=$((20000 + RANDOM % 20000))
+    while ! port_free $PORT; do PORT=$((20000 + RANDOM % 20000)); done
+    CMD=(./mcdonalds -b "$BACKEND" -p "$PORT")
+  fi
+
+  stdbuf -oL "${CMD[@]}" > "$TMP/server.log" 2>&1 &
+  SERVER_PID=$!
+
+  for i in $(seq 50); do
+    grep -q "Listening" "$TMP/server.log" && return 0
+    sleep 0.1
+  done
+  echo "error: server did not start"; cat "$TMP/server.log"; exit 3
+}
+
+stop_server() {
+  [ -n "$SERVER_PID" ] || return
+  kill -INT $SERVER_PID 2>/dev/null; sleep 0.2; kill -INT $SERVER_PID 2>/dev/null
+  wait $SERVER_PID 2>/dev/null
+  SERVER_PID=
+}
+
+# verify <client output> <customers>: check replies and print "ok p50_ms max_ms"
+verify() {
+  awk -v expected=$2 '
+    function sorted(str,    n, a, i, j, t, r) {
+      n = split(str, a, " ")
+      for (i = 2; i <= n; i++) for (j = i; j > 1 && a[j-1] > a[j]; j--) { t = a[j]; a[j] = a[j-1]; a[j-1] = t }
+      r = ""; for (i = 1; i <= n; i++) r = r (i > 1 ? " " : "") a[i]
+      return r
+    }
+    match($0, /To server: Can I have .* burger\(s\)\?/) {
+      s = substr($0, RSTART + 21, RLENGTH - 21 - 11); req[$2] = sorted(s)
+    }
+    match($0, /Your order\(.*\) is ready!/) {
+      s = substr($0, RSTART + 11, RLENGTH - 11 - 11); rep[$2] = sorted(s)
+    }
+    /Latency: / { lat[++nlat] = $(NF-1) }
+    END {
+      ok = 0
+      for (t in req) {
+        if (t in rep && rep[t] == req[t]) ok++
+        else printf("  mismatch %s: ordered [%s], got [%s]\n", t, req[t], rep[t]) > "/dev/stderr"
+      }
+      if (length(req) != expected) printf("  %d of %d requests sent\n", length(req), expected) > "/dev/stderr"
+      for (i = 2; i <= nlat; i++) for (j = i; j > 1 && lat[j-1] > lat[j]; j--) { t = lat[j]; lat[j] = lat[j-1]; lat[j-1] = t }
+      printf("%d %.3f %.3f\n", ok, nlat ? lat[int((nlat + 1) / 2)] : 0, nlat ? lat[nlat] : 0)
+    }' "$1"
+}
+
+#--- run workloads
+
+start_server
+echo "server: $KEY (port $PORT), threshold: $THRESHOLD%"
+printf "%-16s %9s %6s %8s %10s %10s %10s  %s\n" server customers ok wall_s req_per_s p50_ms max_ms status
+
+FAIL=0
+: > "$TMP/results.csv"
+for n in $WORKLOADS; do
+  start=$(date +%s%N)
+  ./client -p $PORT $n > "$TMP/client.log" 2>&1
+  end=$(date +%s%N)
+
+  read ok p50 max < <(verify "$TMP/client.log" $n)
+  wall=$(awk -v a=$start -v b=$end 'BEGIN { printf "%.3f", (b - a) / 1e9 }')
+  rps=$(awk -v n=$ok -v w=$wall 'BEGIN { printf "%.2f", n / w }')
+
+  status=ok
+  if [ "$ok" -ne "$n" ]; then
+    status=INCORRECT; FAIL=1
+  elif [ $UPDATE -eq 0 ]; then
+    base=$(awk -F, -v k=$KEY -v n=$n '$1 == k && $2 == n { print $3, $4 }' "$BASELINE" 2>/dev/null)
+    if [ -z "$base" ]; then
+      status="no baseline"
+    else
+      status=$(echo $base | awk -v rps=$rps -v p50=$p50 -v t=$THRESHOLD '{
+        s = "ok"
+        if (rps < $1 * (1 - t / 100)) s = sprintf("REGRESSION throughput %.2f < %.2f", rps, $1)
+        else if (p50 > $2 * (1 + t / 100)) s = sprintf("REGRESSION p50 %.3f > %.3f", p50, $2)
+        print s }')
+      [[ $status == REGRESSION* ]] && [ $FAIL -eq 0 ] && FAIL=2
+    fi
+  fi
+
+  printf "%-16s %9d %6d %8s %10s %10s %10s  %s\n" $KEY $n $ok $wall $rps $p50 $max "$status"
+  echo "$KEY,$n,$rps,$p50" >> "$TMP/results.csv"
+done
+
+if [ $UPDATE -eq 1 ] && [ $FAIL -eq 0 ]; then
+  { [ -f "$BASELINE" ] && grep -v "^$KEY," "$BASELINE" || echo "server,customers,req_per_s,p50_ms"
+    cat "$TMP/results.csv"; } > "$TMP/baseline.csv"
+  mv "$TMP/baseline.csv" "$BASELINE"
+  echo "baseline updated: $BASELINE"
+fi
+
+exit $FAIL
@@ -0,0 +1,92 @@
+#!/bin/bash
+#--------------------------------------------------------------------------------------------------
+# Network Lab                             Spring 2024                           System Programming
+#
+# bench/hangup.sh
+#
+# Hangup regression test. For each backend, a customer orders BURGERS bigmacs over TCP, closes the
+# connection while they are cooking, and the server must count one cancelled request and save
+# kitchen time by not cooking the rest of the order.
+#
+# usage: bench/hangup.sh [-b "thread uring"] [-n burgers]
+#
+# exit status: 0 ok, 1 the departure was not noticed, 3 setup error
+#
+
+cd "$(dirname "$0")/.." || exit 3
+
+BACKENDS="thread uring"
+BURGERS=100
+
+while getopts "b:n:" opt; do
+  case $opt in
+    b) BACKENDS=$OPTARG ;;
+    n) BURGERS=$OPTARG ;;
+    *) sed -n 's/^# usage: /usage: /p' "$0"; exit 3 ;;
+  esac
+done
+
+make -s mcdonalds || exit 3
+
+TMP=$(mktemp -d)
+trap 'stop_server; rm -rf "$TMP"' EXIT
+
+#--- helpers
+
+# port_free <port>: succeeds if nothing accepts connections on <port>
+port_free() {
+  ! (exec 3<>/dev/tcp/127.0.0.1/$1) 2>/dev/null
+}
+
+# start_server <backend>: launch the server on a free port and wait until it listens
+start_server() {
+  PORT=$((20000 + RANDOM % 20000))
+  while ! port_free $PORT; do PORT=$((20000 + RANDOM % 20000)); done
+
+  stdbuf -oL ./mcdonalds -b "$1" -p "$PORT" > "$TMP/server.log" 2>&1 &
+  SERVER_PID=$!
+
+  for i in $(seq 50); do
+    grep -q "Listening" "$TMP/server.log" && return 0
+    sleep 0.1
+  done
+  echo "error: server did not start"; cat "$TMP/server.log"; exit 3
+}
+
+stop_server() {
+  [ -n "$SERVER_PID" ] || return
+  kill -INT $SERVER_PID 2>/dev/null; sleep 0.2; kill -INT $SERVER_PID 2>/dev/null
+  wait $SERVER_PID 2>/dev/null
+  SERVER_PID=
+}
+
+#--- run
+
+printf "%-8s %8s %10s %10s  %s\n" backend burgers cancelled saved_s status
+
+FAIL=0
+for b in $BACKENDS; do
+  start_server $b
+
+  # order, wait until the kitchens are busy with the order, then close the connection
+  exec 3<>/dev/tcp/127.0.0.1/$PORT || exit 3
+  read -r -t 5 welcome <&3
+  printf "%s\n" "$(yes bigmac | head -n $BURGERS | tr '\n' ' ')" >&3
+  sleep 1
+  exec 3>&-
+
+  # the serving thread polls every 100 ms; give it time to notice and cancel
+  sleep 1
+  stop_server
+
+  read cancelled saved < <(sed -n \
+    's/^Number of cancelled requests: \([0-9]*\) (saved \([0-9]*\) s.*/\1 \2/p' "$TMP/server.log")
+  status=ok
+  if [ "${cancelled:-0}" -ne 1 ] || [ "${saved:-0}" -le 0 ]; then
+    status=FAILED; FAIL=1
+  fi
+
+  printf "%-8s %8d %10s %10s  %s\n" $b $BURGERS "${cancelled:--}" "${saved:--}" $status
+done
+
+exit $FAIL
@@ -0,0 +1,282 @@
+//--------------------------------------------------------------------------------------------------
+// Network Lab                             Spring 2024                           System Programming
+//
+/// @file  bench/micro.c
+/// @brief microbenchmarks of the mcdonalds building blocks.
+///        Links against mcdonalds.c compiled with MCDONALDS_NO_MAIN and prints CSV (see bench.h).
+///
+/// @section changelog Change Log
+/// 2026/10/18 ARC lab created
+///
+/// @section license_section License
+/// Copyright (c) 2024-2026, Architecture and Code Optimization Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS  BE LIABLE FOR ANY DIRECT,  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY,  OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS; OR BUSINESS INTERRUPTION)  HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "net.h"
+#include "journal.h"
+#include "burger.h"
+#include "bench.h"
+
+/// @name mcdonalds.c functions under test
+/// @{
+
+typedef struct __node Node;
+
+void init_server_ctx(void);
+Node** issue_orders(unsigned int customerID, enum burger_type *types, unsigned int burger_count,
+                    unsigned int deadline_ms, void *notify);
+Node* get_order(void);
+void free_orders(Node **order_list, unsigned int burger_count);
+enum burger_type* parse_request(const char *request, size_t len, unsigned int *burger_count,
+                                unsigned int *deadline_ms);
+size_t format_goodbye(char **buf, size_t *buflen, enum burger_type *made,
+                      unsigned int burger_count);
+
+/// @}
+
+#define QUEUE_REQUESTS  (1 << 16)                           ///< requests per queue benchmark run
+#define LINES           (1 << 14)                           ///< lines per socketpair run
+#define ITERATIONS      (1 << 20)                           ///< iterations of single-thread runs
+#define COMMITS         512                                 ///< journal commits per thread
+
+static enum burger_type request_types[MAX_BURGERS];         ///< burgers of a request
+static const char request_line[] = "bigmac cheese chicken\n";
+
+/// @brief arguments of queue producer/consumer threads
+struct queue_arg {
+  unsigned int requests;                                    ///< requests to issue (producer)
+  unsigned long orders;                                     ///< orders to dequeue (consumer)
+  Node ***lists;                                            ///< issued order lists (producer)
+};
+
+static void* queue_producer(void *data)
+{
+  struct queue_arg *arg = (struct queue_arg *)data;
+
+  for (unsigned int i = 0; i < arg->requests; i++) {
+    arg->lists[i] = issue_orders(i, request_types, MAX_BURGERS, 0, NULL);
+  }
+  return NULL;
+}
+
+static void* queue_consumer(void *data)
+{
+  struct queue_arg *arg = (struct queue_arg *)data;
+  unsigned long done = 0;
+
+  while (done < arg->orders) {
+    if (get_order() != NULL) done++;
+  }
+  return NULL;
+}
+
+/// @brief OrderList enqueue/dequeue throughput with @a np producers and @a nc consumers
+static void bench_queue(int np, int nc)
+{
+  pthread_t tid[np + nc];
+  struct queue_arg args[np + nc];
+  unsigned int per_producer = QUEUE_REQUESTS / np;
+  unsigned long orders = (unsigned long)per_producer * np * MAX_BURGERS;
+  char param[32];
+  double start;
+  int i;
+
+  for (i = 0; i < np; i++) {
+    args[i].requests = per_producer;
+    args[i].lists = (Node ***)malloc(sizeof(Node **) * per_producer);
+  }
+  for (i = 0; i < nc; i++) {
+    args[np + i].orders = orders / nc + (i < orders % nc);
+  }
+
+  start = bench_now();
+  for (i = 0; i < np + nc; i++) {
+    pthread_create(&tid[i], NULL, i < np ? queue_producer : queue_consumer, &args[i]);
+  }
+  for (i = 0; i < np + nc; i++) pthread_join(tid[i], NULL);
+
+  // one op = one enqueued and dequeued order
+  snprintf(param, sizeof(param), "%dp%dc", np, nc);
+  bench_report("orderlist_enqueue_dequeue", param, orders, bench_now() - start);
+
+  for (i = 0; i < np; i++) {
+    for (unsigned int j = 0; j < per_producer; j++) free_orders(args[i].lists[j], MAX_BURGERS);
+    free(args[i].lists);
+  }
+}
+
+/// @brief allocation cost of issuing and releasing one request
+static void bench_issue_orders(void)
+{
+  Node **list;
+  double start;
+  char param[32];
+
+  start = bench_now();
+  for (unsigned int i = 0; i < ITERATIONS / 16; i++) {
+    list = issue_orders(i, request_types, MAX_BURGERS, 0, NULL);
+    for (int j = 0; j < MAX_BURGERS; j++) get_order();
+    free_orders(list, MAX_BURGERS);
+  }
+
+  snprintf(param, sizeof(param), "burgers=%d", MAX_BURGERS);
+  bench_report("issue_orders_free_orders", param, ITERATIONS / 16, bench_now() - start);
+}
+
+static void* line_writer(void *data)
+{
+  int sock = *(int *)data;
+
+  for (int i = 0; i < LINES; i++) put_line(sock, (char *)request_line, sizeof(request_line));
+  return NULL;
+}
+
+/// @brief put_line()/get_line() round trip over a socketpair
+static void bench_lines(void)
+{
+  int sv[2];
+  pthread_t tid;
+  size_t buflen = BUF_INITIAL;
+  char *buffer = buf_alloc(&buflen);
+  double start;
+
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+    perror("socketpair");
+    buf_free(buffer, buflen);
+    return;
+  }
+
+  start = bench_now();
+  pthread_create(&tid, NULL, line_writer, &sv[0]);
+  for (int i = 0; i < LINES; i++) get_line(sv[1], &buffer, &buflen);
+  pthread_join(tid, NULL);
+
+  bench_report("put_line_get_line", "socketpair", LINES, bench_now() - start);
+
+  close(sv[0]);
+  close(sv[1]);
+  buf_free(buffer, buflen);
+}
+
+/// @brief request line parsing
+static void bench_parse(void)
+{
+  enum burger_type *types;
+  unsigned int count, deadline_ms;
+  double start;
+
+  start = bench_now();
+  for (int i = 0; i < ITERATIONS; i++) {
+    types = parse_request(request_line, sizeof(request_line) - 1, &count, &deadline_ms);
+    free(types);
+  }
+
+  bench_report("parse_request", "burgers=3", ITERATIONS, bench_now() - start);
+}
+
+/// @brief reply string building
+static void bench_goodbye(void)
+{
+  size_t buflen = BUF_INITIAL;
+  char *buffer = buf_alloc(&buflen);
+  char param[32];
+  double start;
+
+  start = bench_now();
+  for (int i = 0; i < ITERATIONS; i++) {
+    format_goodbye(&buffer, &buflen, request_types, MAX_BURGERS);
+    __asm__ volatile("" : : "r"(buffer) : "memory");
+  }
+
+  snprintf(param, sizeof(param), "burgers=%d", MAX_BURGERS);
+  bench_report("format_goodbye", param, ITERATIONS, bench_now() - start);
+  buf_free(buffer, buflen);
+}
+
+static void* journal_committer(void *data)
+{
+  struct journal *j = (struct journal *)data;
+
+  for (int i = 0; i < COMMITS; i++) {
+    journal_commit(j, journal_append(j, JOURNAL_ORDER, i, request_types, MAX_BURGERS));
+  }
+  return NULL;
+}
+
+/// @brief durable request journaling with @a nt concurrent committers (group commit)
+static void bench_journal(int nt)
+{
+  struct journal j;
+  pthread_t tid[nt];
+  char path[64], param[48];
+  double start;
+  int i;
+
+  snprintf(path, sizeof(path), "/tmp/mcdonalds-bench-%d.journal", getpid());
+  if (journal_open(&j, path) < 0) {
+    perror(path);
+    return;
+  }
+
+  start = bench_now();
+  for (i = 0; i < nt; i++) pthread_create(&tid[i], NULL, journal_committer, &j);
+  for (i = 0; i < nt; i++) pthread_join(tid[i], NULL);
+
+  // one op = one durable request; fsyncs shows how many syncs the group commit needed
+  snprintf(param, sizeof(param), "threads=%d/fsyncs=%lu", nt, j.syncs);
+  bench_report("journal_commit", param, (unsigned long)nt * COMMITS, bench_now() - start);
+
+  journal_close(&j);
+  unlink(path);
+}
+
+int main(int argc, char *argv[])
+{
+  static const int threads[][2] = { { 1, 1 }, { 1, 4 }, { 4, 1 }, { 4, 4 }, { 16, 16 } };
+
+  init_server_ctx();
+  for (int i = 0; i < MAX_BURGERS; i++) request_types[i] = i % BURGER_TYPE_MAX;
+
+  bench_header();
+  for (int i = 0; i < sizeof(threads) / sizeof(threads[0]); i++) {
+    bench_queue(threads[i][0], threads[i][1]);
+  }
+  bench_issue_orders();
+  bench_lines();
+  bench_parse();
+  bench_goodbye();
+  bench_journal(1);
+  bench_journal(8);
+  bench_journal(32);
+
+  return EXIT_SUCCESS;
+}
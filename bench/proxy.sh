@@ -0,0 +1,46 @@
+#!/bin/bash
+#--------------------------------------------------------------------------------------------------
+# Network Lab                             Spring 2024                           System Programming
+#
+# bench/proxy.sh
+#
+# Run the load-balancing proxy in front of several mcdonalds backends on one machine and drive it
+# with ./client. Backend i listens on BASE+i (customers) and BASE+100+i (status).
+#
+# usage: bench/proxy.sh [backends] [customers]      (default: 3 backends, 30 customers)
+#
+
+cd "$(dirname "$0")/.." || exit 1
+make -s mcdonalds client proxy || exit 1
+
+NB=${1:-3}
+NC=${2:-30}
+BASE=$((20000 + RANDOM % 20000))
+PROXY_PORT=$((BASE + 200))
+TMP=$(mktemp -d)
+
+pids=()
+spec=()
+for i in $(seq 0 $((NB - 1))); do
+  ./mcdonalds -p $((BASE + i)) -s $((BASE + 100 + i)) > "$TMP/backend$i.log" 2>&1 &
+  pids+=($!)
+  spec+=("$((BASE + i)):$((BASE + 100 + i))")
+done
+sleep 0.5
+
+./proxy -p $PROXY_PORT "${spec[@]}" > "$TMP/proxy.log" 2>&1 &
+proxy=$!
+sleep 0.5
+
+start=$(date +%s%N)
+served=$(./client -p $PROXY_PORT $NC | grep -c "Goodbye")
+end=$(date +%s%N)
+
+kill -INT $proxy; wait $proxy 2>/dev/null
+for p in "${pids[@]}"; do kill -INT $p; done; sleep 0.2
+for p in "${pids[@]}"; do kill -INT $p 2>/dev/null; done; wait 2>/dev/null
+
+cat "$TMP/proxy.log"
+awk -v n=$NC -v s=$served -v a=$start -v b=$end \
+  'BEGIN { printf "%d of %d customers served in %.3f s\n", s, n, (b - a) / 1e9 }'
+rm -rf "$TMP"
@@ -0,0 +1,128 @@
+//--------------------------------------------------------------------------------------------------
+// Network Lab                             Spring 2024                           System Programming
+//
+/// @file  bench/tokenizer.c
+/// @brief microbenchmark: request_tokenize() vs. strtok_r() + strcmp() baseline
+///
+/// @section changelog Change Log
+/// 2026/10/18 ARC lab created
+///
+/// @section license_section License
+/// Copyright (c) 2024-2026, Architecture and Code Optimization Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS  BE LIABLE FOR ANY DIRECT,  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY,  OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS; OR BUSINESS INTERRUPTION)  HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "request.h"
+#include "burger.h"
+#include "bench.h"
+
+/// @brief strtok_r() + strcmp() baseline as used by the original serve_client()
+static int baseline_tokenize(char *line, enum burger_type **types, unsigned int *capacity)
+{
+  unsigned int count = 0;
+  char *burger, *saveptr;
+  int i;
+
+  burger = strtok_r(line, " \t\r\n", &saveptr);
+  while (burger != NULL) {
+    for (i = 0; i < BURGER_TYPE_MAX; i++) {
+      if (strcmp(burger, burger_names[i]) == 0) break;
+    }
+    if (i == BURGER_TYPE_MAX) return -1;
+
+    if (count == *capacity) {
+      *capacity = *capacity ? *capacity << 1 : 4;
+      *types = (enum burger_type *)realloc(*types, sizeof(enum burger_type) * *capacity);
+    }
+    (*types)[count++] = i;
+
+    burger = strtok_r(NULL, " \t\r\n", &saveptr);
+  }
+
+  return count;
+}
+
+int main(int argc, char *argv[])
+{
+  unsigned int tokens = argc > 1 ? atoi(argv[1]) : 4096;
+  unsigned int iterations = argc > 2 ? atoi(argv[2]) : 2000;
+  enum burger_type *t1 = NULL, *t2 = NULL;
+  unsigned int c1 = 0, c2 = 0, i;
+  size_t len = 0;
+  char *line, *scratch;
+  double start, base_s, fast_s;
+  char param[32];
+  int n1 = 0, n2 = 0;
+
+  // build a request line of random burgers
+  srand(1);
+  line = (char *)malloc(tokens * 8 + 2);
+  scratch = (char *)malloc(tokens * 8 + 2);
+  for (i = 0; i < tokens; i++) {
+    const char *name = burger_names[rand() % BURGER_TYPE_MAX];
+    len += sprintf(line + len, i ? " %s" : "%s", name);
+  }
+  line[len++] = '\n';
+  line[len] = '\0';
+
+  // baseline tokenizes a copy since strtok_r() modifies its input
+  start = bench_now();
+  for (i = 0; i < iterations; i++) {
+    memcpy(scratch, line, len + 1);
+    n1 = baseline_tokenize(scratch, &t1, &c1);
+  }
+  base_s = bench_now() - start;
+
+  start = bench_now();
+  for (i = 0; i < iterations; i++) {
+    n2 = request_tokenize(line, len, &t2, &c2);
+  }
+  fast_s = bench_now() - start;
+
+  if ((n1 != tokens) || (n2 != tokens) || memcmp(t1, t2, sizeof(enum burger_type) * tokens)) {
+    printf("error: tokenizers disagree (%d vs %d tokens)\n", n1, n2);
+    return EXIT_FAILURE;
+  }
+  if ((request_tokenize("bigmac cheesy\n", 14, &t2, &c2) != -1) ||
+      (request_tokenize("bigmacs\n", 8, &t2, &c2) != -1)) {
+    printf("error: unknown burger accepted\n");
+    return EXIT_FAILURE;
+  }
+
+  // one op = one token
+  snprintf(param, sizeof(param), "tokens=%u", tokens);
+  bench_header();
+  bench_report("tokenize_strtok_strcmp", param, (unsigned long)tokens * iterations, base_s);
+  bench_report("tokenize_request", param, (unsigned long)tokens * iterations, fast_s);
+
+  free(t1);
+  free(t2);
+  free(line);
+  free(scratch);
+
+  return EXIT_SUCCESS;
+}
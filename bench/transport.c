@@ -0,0 +1,172 @@
+//--------------------------------------------------------------------------------------------------
+// Network Lab                             Spring 2024                           System Programming
+//
+/// @file  bench/transport.c
+/// @brief latency/throughput of the shared-memory transport vs. TCP loopback
+///
+/// @section changelog Change Log
+/// 2026/10/18 ARC lab created
+///
+/// @section license_section License
+/// Copyright (c) 2024-2026, Architecture and Code Optimization Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS  BE LIABLE FOR ANY DIRECT,  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY,  OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS; OR BUSINESS INTERRUPTION)  HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <unistd.h>
+
+#include "net.h"
+#include "shm.h"
+#include "burger.h"
+#include "bench.h"
+
+#define ROUNDTRIPS 20000                                    ///< request/reply pairs per run
+#define STREAM     100000                                   ///< one-way lines per run
+
+static const char request_line[] = "bigmac cheese chicken\n";
+
+/// @brief one end of a connection over either transport
+struct end {
+  int fd;                                                   ///< TCP socket
+  struct shm_endpoint *shm;                                 ///< shm endpoint or NULL
+  int listenfd;                                             ///< listening socket (server side)
+};
+
+static int end_get_line(struct end *e, char **buf, size_t *len)
+{
+  return e->shm ? shm_get_line(e->shm, buf, len) : get_line(e->fd, buf, len);
+}
+
+static int end_put_line(struct end *e, char *buf, size_t len)
+{
+  return e->shm ? shm_put_line(e->shm, buf, len) : put_line(e->fd, buf, len);
+}
+
+/// @brief server side: echo ROUNDTRIPS lines, then drain STREAM lines
+static void* server_task(void *data)
+{
+  struct end *e = (struct end *)data;
+  size_t buflen = BUF_INITIAL;
+  char *buffer = buf_alloc(&buflen);
+  int i;
+
+  for (i = 0; i < ROUNDTRIPS; i++) {
+    if (end_get_line(e, &buffer, &buflen) <= 0) break;
+    end_put_line(e, buffer, buflen);
+  }
+  for (i = 0; i < STREAM; i++) {
+    if (end_get_line(e, &buffer, &buflen) <= 0) break;
+  }
+  end_put_line(e, "done\n", 6);
+
+  buf_free(buffer, buflen);
+  return NULL;
+}
+
+static void run(const char *name, struct end *client, struct end *server)
+{
+  size_t buflen = BUF_INITIAL;
+  char *buffer = buf_alloc(&buflen);
+  pthread_t tid;
+  double start;
+  int i;
+
+  pthread_create(&tid, NULL, server_task, server);
+
+  start = bench_now();
+  for (i = 0; i < ROUNDTRIPS; i++) {
+    end_put_line(client, (char *)request_line, sizeof(request_line));
+    end_get_line(client, &buffer, &buflen);
+  }
+  bench_report("transport_roundtrip", name, ROUNDTRIPS, bench_now() - start);
+
+  start = bench_now();
+  for (i = 0; i < STREAM; i++) end_put_line(client, (char *)request_line, sizeof(request_line));
+  end_get_line(client, &buffer, &buflen);
+  bench_report("transport_stream", name, STREAM, bench_now() - start);
+
+  pthread_join(tid, NULL);
+  buf_free(buffer, buflen);
+}
+
+/// @brief accept the TCP connection of the benchmark client
+static void* tcp_accept(void *data)
+{
+  struct end *e = (struct end *)data;
+  e->fd = accept(e->listenfd, NULL, NULL);
+  return NULL;
+}
+
+/// @brief accept the shm connection of the benchmark client
+static void* shm_accept_task(void *data)
+{
+  struct end *e = (struct end *)data;
+  e->shm = shm_accept(e->listenfd);
+  return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+  struct end client = { -1, NULL, -1 }, server = { -1, NULL, -1 };
+  char path[64];
+  pthread_t tid;
+  unsigned short port;
+
+  bench_header();
+
+  // TCP over loopback on the first free port above PORT
+  for (port = PORT + 1000; (server.listenfd = open_listenfd(port)) < 0; port++);
+  pthread_create(&tid, NULL, tcp_accept, &server);
+  client.fd = open_clientfd(IP, port);
+  pthread_join(tid, NULL);
+  if ((client.fd < 0) || (server.fd < 0)) {
+    printf("error: cannot set up TCP connection\n");
+    return EXIT_FAILURE;
+  }
+  run("tcp", &client, &server);
+  close(client.fd);
+  close(server.fd);
+  close(server.listenfd);
+
+  // shared memory negotiated over a Unix socket
+  snprintf(path, sizeof(path), "/tmp/mcdonalds-bench-%d.sock", getpid());
+  server.listenfd = shm_listen(path);
+  pthread_create(&tid, NULL, shm_accept_task, &server);
+  client.shm = shm_connect(path);
+  pthread_join(tid, NULL);
+  if ((client.shm == NULL) || (server.shm == NULL)) {
+    printf("error: cannot set up shared-memory connection\n");
+    return EXIT_FAILURE;
+  }
+  run("shm", &client, &server);
+  shm_close(client.shm);
+  shm_close(server.shm);
+  close(server.listenfd);
+  unlink(path);
+
+  return EXIT_SUCCESS;
+}
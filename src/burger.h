@@ -33,6 +33,9 @@
 /// DAMAGE.
 //--------------------------------------------------------------------------------------------------
 
+#ifndef __BURGER_H__
+#define __BURGER_H__
+
 /// @name Macro definitions
 /// @{
 
@@ -63,3 +66,4 @@ enum burger_type {
 
 extern char *burger_names[];                              ///< burger names as strings
 
+#endif // __BURGER_H__
@@ -11,6 +11,7 @@
 /// 2020/11/18 Hyunik Kim created
 /// 2021/11/23 Jaume Mateu Cuadrat cleanup, add milestones
 /// 2024/05/31 ARC lab add multiple orders per request
+/// 2026/10/18 ARC lab add trace replay
 ///
 /// @section license_section License
 /// Copyright (c) 2020-2023, Computer Systems and Platforms Laboratory, SNU
@@ -44,6 +45,7 @@
 #include <pthread.h>
 #include <errno.h>
 #include <time.h>
+#include <signal.h>
 
 #include <sys/socket.h>
 #include <unistd.h>
@@ -51,51 +53,214 @@
 #include <netdb.h>
 
 #include "net.h"
+#include "shm.h"
+#include "trace.h"
 #include "burger.h"
 
+unsigned short port = PORT;                                 ///< server port
+struct net_options net_opt = NET_OPTIONS_DEFAULT;           ///< connection tuning
+const char *shm_path = NULL;                                ///< shm transport socket (NULL: TCP)
+unsigned int deadline_ms = 0;                               ///< requested deadline (0: none)
+unsigned int seed = 1;                                      ///< base seed of the per-thread RNGs
+const char *replay_path = NULL;                             ///< trace to replay (NULL: synthetic)
+double replay_speed = 1.0;                                  ///< replay speed-up factor
+unsigned int stream_burgers = 0;                            ///< burgers per streamed order (0: off)
+
+#define STREAM_SEND_CHUNK 4096                              ///< bytes of a streamed order per send
+
+/// @brief request issued by one client thread
+struct client_order {
+  unsigned int seed;                                        ///< RNG state for random burgers
+  unsigned int burger_count;                                ///< number of burgers in @a types
+  enum burger_type *types;                                  ///< burgers to order (NULL: random)
+  unsigned int deadline_ms;                                 ///< requested deadline (0: none)
+};
+
+/// @brief read a line from the server over TCP or the shared-memory transport (see get_line())
+static int server_get_line(int socketfd, struct shm_endpoint *shm, char **buf, size_t *cur_len)
+{
+  if (shm != NULL) return shm_get_line(shm, buf, cur_len);
+  return get_line(socketfd, buf, cur_len);
+}
+
+/// @brief write a line to the server over TCP or the shared-memory transport (see put_line())
+static int server_put_line(int socketfd, struct shm_endpoint *shm, char *buf, size_t len)
+{
+  if (shm != NULL) return shm_put_line(shm, buf, len);
+  return put_line(socketfd, buf, len);
+}
+
+/// @brief streamed order sent by a writer thread while the client thread reads the replies
+struct client_stream {
+  int serverfd;                                             ///< server socket (TCP)
+  struct shm_endpoint *shm;                                 ///< shared-memory transport or NULL
+  char *line;                                               ///< burger line including '\n'
+  size_t len;                                               ///< length of @a line
+  int result;                                               ///< <0 if sending failed
+};
+
 /// @brief client error function
 /// @param socketfd file drescriptor of the socket
-void error_client(int socketfd) {
-	close(socketfd);
-  	pthread_exit(NULL);
+/// @param shm shared-memory endpoint or NULL
+/// @param buffer message buffer
+/// @param buflen size of @a buffer
+void error_client(int socketfd, struct shm_endpoint *shm, char *buffer, size_t buflen) {
+  buf_free(buffer, buflen);
+  if (shm != NULL) shm_close(shm);
+  else close(socketfd);
+  pthread_exit(NULL);
+}
+
+/// @brief writer thread of a streamed order: send the header line, then the burger line in chunks
+///        of STREAM_SEND_CHUNK bytes so the server can start cooking before the line is complete
+/// @param data struct client_stream
+static void *stream_writer(void *data)
+{
+  struct client_stream *cs = (struct client_stream *)data;
+  char header[] = "stream\n";
+  size_t pos, n;
+
+  cs->result = server_put_line(cs->serverfd, cs->shm, header, sizeof(header) - 1);
+
+  // the shared-memory transport sends whole lines
+  if ((cs->result > 0) && (cs->shm != NULL)) {
+    cs->result = shm_put_line(cs->shm, cs->line, cs->len);
+  }
+  for (pos = 0; (cs->result > 0) && (cs->shm == NULL) && (pos < cs->len); pos += n) {
+    n = cs->len - pos < STREAM_SEND_CHUNK ? cs->len - pos : STREAM_SEND_CHUNK;
+    cs->result = put_data(cs->serverfd, cs->line + pos, n);
+  }
+
+  return NULL;
+}
+
+/// @brief order @a stream_burgers random burgers as a streamed order and read the batches of
+///        burgers handed out until the final message
+/// @param serverfd server socket (TCP)
+/// @param shm shared-memory endpoint or NULL
+/// @param order order of the thread (for its RNG)
+/// @param start time the thread connected
+/// @param buffer message buffer. In/out parameter.
+/// @param buflen size of @a buffer. In/out parameter.
+/// @retval 0 on success
+/// @retval -1 if the connection failed
+static int stream_order(int serverfd, struct shm_endpoint *shm, struct client_order *order,
+                        const struct timespec *start, char **buffer, size_t *buflen)
+{
+  struct client_stream cs = { serverfd, shm, NULL, 0, 0 };
+  struct timespec first = { 0, 0 }, end;
+  unsigned int ready = 0, batches = 0;
+  pthread_t tid = pthread_self(), writer;
+  size_t cap = 0;
+  int read, choice;
+
+  // build the burger line up front; the writer thread hands it out in chunks
+  for (unsigned int i = 0; i < stream_burgers; i++) {
+    choice = rand_r(&order->seed) % BURGER_TYPE_MAX;
+    while (cs.len + strlen(burger_names[choice]) + 2 > cap) {
+      cap = cap ? cap * 2 : STREAM_SEND_CHUNK;
+      cs.line = (char *)realloc(cs.line, cap);
+    }
+    cs.len += sprintf(cs.line + cs.len, i == 0 ? "%s" : " %s", burger_names[choice]);
+  }
+  cs.line[cs.len++] = '\n';
+  cs.line[cs.len] = '\0';
+
+  printf("[Thread %lu] Streaming %u burgers\n", tid, stream_burgers);
+
+  if (pthread_create(&writer, NULL, stream_writer, &cs) != 0) {
+    perror("pthread_create");
+    free(cs.line);
+    return -1;
+  }
+
+  // read "Ready:" lines until the final message
+  while ((read = server_get_line(serverfd, shm, buffer, buflen)) > 0) {
+    if (strncmp(*buffer, "Ready: ", 7) != 0) break;
+    if (batches++ == 0) clock_gettime(CLOCK_MONOTONIC, &first);
+    ready++;
+    for (char *p = *buffer + 7; *p != '\0'; p++) ready += (*p == ' ');
+  }
+
+  pthread_join(writer, NULL);
+  free(cs.line);
+
+  if (read <= 0) {
+    printf("Cannot read data from server\n");
+    return -1;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  printf("[Thread %lu] From server: %s", tid, *buffer);
+  if (batches > 0) {
+    printf("[Thread %lu] Received %u burgers in %u batches, first after %.3f ms\n", tid, ready,
+           batches, (first.tv_sec - start->tv_sec) * 1e3 + (first.tv_nsec - start->tv_nsec) * 1e-6);
+  }
+  printf("[Thread %lu] Latency: %.3f ms\n", tid,
+         (end.tv_sec - start->tv_sec) * 1e3 + (end.tv_nsec - start->tv_nsec) * 1e-6);
+
+  return 0;
 }
 
 /// @brief client task for connection thread
+/// @param data struct client_order of the thread
 void *thread_task(void *data)
 {
-  struct addrinfo *ai, *ai_it;
-  size_t read, sent, buflen;
+  struct client_order *order = (struct client_order *)data;
+  struct shm_endpoint *shm = NULL;
+  ssize_t read, sent;
+  size_t buflen;
   int serverfd = -1;
   char *buffer;
   pthread_t tid;
   int *choices;
   unsigned int burger_count;
 
+  struct timespec start, end;
+
   tid = pthread_self();
+  clock_gettime(CLOCK_MONOTONIC, &start);
 
-  buffer = (char *)malloc(BUF_SIZE);
-  buflen = BUF_SIZE;
+  buflen = BUF_INITIAL;
+  buffer = buf_alloc(&buflen);
 
-  // Connect to McDonald's server
-  //
-  // Use getsocklist() to get the socket list
-  // TODO
-  
-  // Iterate over addrinfos and try to connect
-  // TODO
+  // Connect to McDonald's server over TCP or the shared-memory transport
+  if (shm_path != NULL) shm = shm_connect(shm_path);
+  else serverfd = open_clientfd_opt(IP, port, &net_opt);
+
+  if ((serverfd < 0) && (shm == NULL)) {
+    printf("[Thread %lu] Cannot connect to server\n", tid);
+    buf_free(buffer, buflen);
+    pthread_exit(NULL);
+  }
 
   // Read welcome message from the server
-  read = get_line(serverfd, &buffer, &buflen);
+  read = server_get_line(serverfd, shm, &buffer, &buflen);
   if (read <= 0) {
     printf("Cannot read data from server\n");
-    error_client(serverfd);
+    error_client(serverfd, shm, buffer, buflen);
   }
 
   printf("[Thread %lu] From server: %s", tid, buffer);
 
-  // Choose the number of orders for request
-  if(BURGER_NUM_RAND)
-    burger_count = rand() % MAX_BURGERS + 1;
+  // Streamed orders hand out their burgers batch by batch
+  if (stream_burgers > 0) {
+    if (stream_order(serverfd, shm, order, &start, &buffer, &buflen) < 0) {
+      error_client(serverfd, shm, buffer, buflen);
+    }
+    buf_free(buffer, buflen);
+
+    if (shm != NULL) shm_close(shm);
+    else close(serverfd);
+    pthread_exit(NULL);
+  }
+
+  // Choose the number of orders for request (replayed requests bring their own)
+  if (order->types != NULL)
+    burger_count = order->burger_count;
+  else if(BURGER_NUM_RAND)
+    burger_count = rand_r(&order->seed) % MAX_BURGERS + 1;
   else
     burger_count = MAX_BURGERS;
 
@@ -104,7 +269,8 @@ void *thread_task(void *data)
   // Randomly choose burger type for each order
   choices = (int *)malloc(sizeof(int) * burger_count);
   for (int i=0; i<burger_count; i++){
-    int choice = rand() % BURGER_TYPE_MAX;
+    int choice = (order->types != NULL) ? (int)order->types[i]
+                                        : rand_r(&order->seed) % BURGER_TYPE_MAX;
 
     // concat burger to buffer string
     char *temp_buffer;
@@ -117,57 +283,194 @@ void *thread_task(void *data)
       if (res<0) perror("asprintf");
     }
     
-    strncpy(buffer, temp_buffer, BUF_SIZE);
+    // room for the request, the deadline token and the newline
+    while (strlen(temp_buffer) + 16 > buflen) buffer = buf_grow(buffer, &buflen);
+    strcpy(buffer, temp_buffer);
     free(temp_buffer);
 
     choices[i] = choice;
   }
 
   printf("[Thread %lu] To server: Can I have %s burger(s)?\n", tid, buffer);
+
+  // Append the deadline token
+  if (order->deadline_ms > 0) {
+    size_t len = strnlen(buffer, buflen);
+    snprintf(buffer + len, buflen - len, " @%u", order->deadline_ms);
+  }
   
-  int str_len = strnlen(buffer, BUF_SIZE);
+  int str_len = strnlen(buffer, buflen);
   buffer[str_len] = '\n';
+  buffer[str_len + 1] = '\0';
 
   // Send request to the server
-  sent = put_line(serverfd, buffer, strlen(buffer));
+  sent = server_put_line(serverfd, shm, buffer, strlen(buffer));
   if (sent < 0) {
     printf("Error: cannot send data to server\n");
-    error_client(serverfd);
+    free(choices);
+    error_client(serverfd, shm, buffer, buflen);
   }
 
   // Get final message from the server
-  memset(buffer, 0, BUF_SIZE);
-  read = get_line(serverfd, &buffer, &buflen);
+  memset(buffer, 0, buflen);
+  read = server_get_line(serverfd, shm, &buffer, &buflen);
   if (read <= 0) {
     printf("Cannot read data from server\n");
-    error_client(serverfd);
+    free(choices);
+    error_client(serverfd, shm, buffer, buflen);
   }
 
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
   printf("[Thread %lu] From server: %s", tid, buffer);
+  printf("[Thread %lu] Latency: %.3f ms\n", tid,
+         (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) * 1e-6);
 
   free(choices);
+  buf_free(buffer, buflen);
 
-  close(serverfd);
-  freeaddrinfo(ai);
+  if (shm != NULL) shm_close(shm);
+  else close(serverfd);
   pthread_exit(NULL);
 }
 
+/// @brief derive the RNG seed of thread @a i from the base seed. rand_r() mostly depends on the
+///        low bits of its state, so the seeds are hashed to give every thread a distinct stream.
+static unsigned int thread_seed(unsigned int base, size_t i)
+{
+  unsigned int x = base + (unsigned int)i * 2654435761u;
+
+  x ^= x >> 16;
+  x *= 0x7feb352d;
+  x ^= x >> 15;
+  x *= 0x846ca68b;
+  x ^= x >> 16;
+  return x;
+}
+
+/// @brief print the usage
+static void usage(void)
+{
+  printf("usage ./client [-d deadline_ms | -n burgers] [-o option=value] "
+         "[-p port | -u shm_socket] [-s seed] <num_threads>\n"
+         "      ./client [-o option=value] [-p port | -u shm_socket] -r trace [-x speed] "
+         "[max_requests]\n");
+}
+
+/// @brief start one thread per order and wait for all of them. Orders with an arrival time are
+///        started at that time (relative to the first, divided by the replay speed).
+/// @param orders orders
+/// @param at arrival times in ns, NULL to start all threads at once
+/// @param count number of orders
+static void run_orders(struct client_order *orders, const uint64_t *at, size_t count)
+{
+  pthread_t *threads = (pthread_t *)malloc(sizeof(pthread_t) * count);
+  struct timespec start, due;
+  uint64_t offset;
+  size_t i;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (i = 0; i < count; i++) {
+    // sleep until the arrival time of the request; absolute deadlines keep errors from adding up
+    if (at != NULL) {
+      offset = (uint64_t)((at[i] - at[0]) / replay_speed);
+      due.tv_sec = start.tv_sec + offset / 1000000000ULL;
+      due.tv_nsec = start.tv_nsec + offset % 1000000000ULL;
+      if (due.tv_nsec >= 1000000000L) {
+        due.tv_sec++;
+        due.tv_nsec -= 1000000000L;
+      }
+      while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL) == EINTR) ;
+    }
+
+    if (pthread_create(&threads[i], NULL, thread_task, &orders[i]) != 0) {
+      perror("pthread_create");
+      count = i;
+      break;
+    }
+  }
+
+  // have all threads join before exiting
+  for (i = 0; i < count; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  free(threads);
+}
+
 /// @brief program entry point
 int main(int argc, char const *argv[])
 {
-  int i;
-  int num_threads;
+  struct client_order *orders;
+  struct trace_request *trace = NULL;
+  uint64_t *at = NULL;
+  size_t i, count, total = 0;
+  long limit = -1;
+  int opt;
+
+  while ((opt = getopt(argc, (char * const *)argv, "d:n:o:p:r:s:u:x:")) != -1) {
+    if (opt == 'd') deadline_ms = atoi(optarg);
+    else if (opt == 'n') stream_burgers = strtoul(optarg, NULL, 0);
+    else if (opt == 'o') {
+      if (net_parse_option(&net_opt, optarg) < 0) {
+        printf("unknown socket option '%s'\n", optarg);
+        return 0;
+      }
+    }
+    else if (opt == 'p') port = atoi(optarg);
+    else if (opt == 'r') replay_path = optarg;
+    else if (opt == 's') seed = strtoul(optarg, NULL, 0);
+    else if (opt == 'u') shm_path = optarg;
+    else if (opt == 'x') replay_speed = atof(optarg);
+    else optind = argc + 1;
+  }
 
-  if (argc != 2) {
-    printf("usage ./client <num_threads>\n");
+  if (argc - optind == 1) limit = atol(argv[optind]);
+  if ((optind > argc) || (argc - optind > 1) || (limit == 0) || (replay_speed <= 0) ||
+      ((replay_path == NULL) && (limit < 0))) {
+    usage();
     return 0;
   }
 
-  //
-  // TODO
-  //
-  // - create n threads where n is the numerical value of argv[1]
-  // - have all threads join before exiting
+  if (replay_path != NULL) {
+    // replay the requests of a trace recorded by `mcdonalds -t` with their interarrival times
+    trace = trace_load(replay_path, &total);
+    if (trace == NULL) {
+      perror(replay_path);
+      return 0;
+    }
+    count = ((limit > 0) && ((size_t)limit < total)) ? (size_t)limit : total;
+
+    orders = (struct client_order *)calloc(count ? count : 1, sizeof(struct client_order));
+    at = (uint64_t *)malloc(sizeof(uint64_t) * (count ? count : 1));
+    for (i = 0; i < count; i++) {
+      orders[i].burger_count = trace[i].burger_count;
+      orders[i].types = trace[i].types;
+      orders[i].deadline_ms = trace[i].deadline_ms;
+      at[i] = trace[i].at;
+    }
+  } else {
+    // create n threads where n is the numerical value of argv[1], each with its own RNG stream
+    count = limit;
+    orders = (struct client_order *)calloc(count, sizeof(struct client_order));
+    for (i = 0; i < count; i++) {
+      orders[i].seed = thread_seed(seed, i);
+      orders[i].deadline_ms = deadline_ms;
+    }
+  }
+
+  // the server closes the connection of an invalid streamed order while it is still being sent
+  if (stream_burgers > 0) signal(SIGPIPE, SIG_IGN);
+
+  run_orders(orders, at, count);
+
+  if (trace != NULL) {
+    printf("Replayed %zu requests (trace span %.3f s) at %.2fx\n", count,
+           count ? (at[count - 1] - at[0]) * 1e-9 : 0.0, replay_speed);
+    trace_free(trace, total);
+  }
+  free(at);
+  free(orders);
 
   return 0;
 }
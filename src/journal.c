@@ -0,0 +1,420 @@
+//--------------------------------------------------------------------------------------------------
+// Network Lab                             Spring 2024                           System Programming
+//
+/// @file  journal.c
+/// @brief write-ahead order journal: append-only, memory-mapped log with group commit
+///
+/// @section changelog Change Log
+/// 2026/10/18 ARC lab created
+///
+/// @section license_section License
+/// Copyright (c) 2024-2026, Architecture and Code Optimization Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS  BE LIABLE FOR ANY DIRECT,  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY,  OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS; OR BUSINESS INTERRUPTION)  HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
+
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "journal.h"
+
+LOCKSTAT_CLASS(journal);                                    ///< `lock` of the journal
+
+/// @internal
+static const char journal_magic[16] = "MCDJOURNAL1";        ///< file header
+
+/// @brief on-disk record; records are 4-byte aligned and the unused file tail is zero
+struct journal_record {
+  uint32_t sum;                                             ///< FNV-1a checksum of the rest
+  uint32_t kind;                                            ///< enum journal_kind
+  uint32_t customerID;                                      ///< customer ID
+  uint32_t burger_count;                                    ///< number of entries in types[]
+  uint8_t types[];                                          ///< burger types, padded to 4 bytes
+};
+
+static size_t record_len(uint32_t burger_count)
+{
+  return sizeof(struct journal_record) + ((burger_count + 3) & ~3u);
+}
+
+static uint32_t record_sum(const struct journal_record *r, size_t len)
+{
+  const uint8_t *p = (const uint8_t *)&r->kind;
+  const uint8_t *end = (const uint8_t *)r + len;
+  uint32_t h = 2166136261u;
+
+  while (p < end) h = (h ^ *p++) * 16777619u;
+  return h;
+}
+
+/// @brief grow file and mapping so that @a need bytes fit. Called with @a j->lock held (or
+///        before the journal is shared).
+static void journal_reserve(struct journal *j, size_t need)
+{
+  size_t size = j->size;
+  void *base;
+
+  if (need <= size) return;
+  while (size < need) size <<= 1;
+
+  if (ftruncate(j->fd, size) < 0) {
+    perror("journal: ftruncate");
+    exit(EXIT_FAILURE);
+  }
+  base = mremap(j->base, j->size, size, MREMAP_MAYMOVE);
+  if (base == MAP_FAILED) {
+    perror("journal: mremap");
+    exit(EXIT_FAILURE);
+  }
+  j->base = (char *)base;
+  j->size = size;
+}
+
+/// @brief store a record at @a pos of the mapping @a base
+/// @retval length of the record
+static size_t record_put(char *base, size_t pos, enum journal_kind kind, unsigned int customerID,
+                         const enum burger_type *types, unsigned int burger_count)
+{
+  size_t len = record_len(burger_count);
+  struct journal_record *r = (struct journal_record *)(base + pos);
+  unsigned int i;
+
+  r->kind = kind;
+  r->customerID = customerID;
+  r->burger_count = burger_count;
+  for (i = 0; i < burger_count; i++) r->types[i] = types[i];
+  r->sum = record_sum(r, len);
+
+  return len;
+}
+
+static size_t journal_write(struct journal *j, enum journal_kind kind, unsigned int customerID,
+                            const enum burger_type *types, unsigned int burger_count)
+{
+  journal_reserve(j, j->tail + record_len(burger_count));
+
+  j->tail += record_put(j->base, j->tail, kind, customerID, types, burger_count);
+  j->records++;
+
+  return j->lsn_base + j->tail;
+}
+
+/// @brief scan the mapped journal @a base of @a size bytes and collect its incomplete requests
+///        in @a orders / @a count. @a next_id is raised above every customer ID found.
+static void journal_scan(const char *base, size_t size, struct journal_order **orders,
+                         unsigned int *count, unsigned int *next_id)
+{
+  struct journal_order **open = NULL, *o;
+  unsigned int capacity = 0, id, i;
+  size_t pos = sizeof(journal_magic), len;
+  const struct journal_record *r;
+
+  if ((size < pos) || (memcmp(base, journal_magic, sizeof(journal_magic)) != 0)) return;
+
+  // stop at the zeroed tail or at a record torn by a crash
+  while (pos + sizeof(struct journal_record) <= size) {
+    r = (const struct journal_record *)(base + pos);
+    if ((r->kind < JOURNAL_ORDER) || (r->kind > JOURNAL_DONE)) break;
+    len = record_len(r->burger_count);
+    if ((len > size - pos) || (record_sum(r, len) != r->sum)) break;
+    pos += len;
+
+    id = r->customerID;
+    if (id >= *next_id) *next_id = id + 1;
+    if (id >= capacity) {
+      unsigned int c = capacity ? capacity : 64;
+      while (c <= id) c <<= 1;
+      open = (struct journal_order **)realloc(open, sizeof(*open) * c);
+      memset(open + capacity, 0, sizeof(*open) * (c - capacity));
+      capacity = c;
+    }
+    o = open[id];
+
+    if (r->kind == JOURNAL_ORDER) {
+      // a streamed request is journaled as several ORDER records, one per batch
+      if (o == NULL) o = open[id] = (struct journal_order *)calloc(1, sizeof(*o));
+      o->customerID = id;
+      o->types = (enum burger_type *)realloc(o->types, sizeof(enum burger_type) *
+                                             (o->burger_count + r->burger_count + 1));
+      for (i = 0; i < r->burger_count; i++) o->types[o->burger_count++] = r->types[i];
+    } else if ((r->kind == JOURNAL_BURGER) && (o != NULL) && (r->burger_count == 1)) {
+      // remove one burger of the made type from the remaining ones
+      for (i = 0; i < o->burger_count; i++) {
+        if (o->types[i] == r->types[0]) {
+          o->types[i] = o->types[--o->burger_count];
+          break;
+        }
+      }
+    } else if ((r->kind == JOURNAL_DONE) && (o != NULL)) {
+      free(o->types);
+      free(o);
+      open[id] = NULL;
+    }
+  }
+
+  // requests whose burgers are all made have no customer left to pick them up
+  for (id = 0; id < capacity; id++) {
+    o = open[id];
+    if (o == NULL) continue;
+    if (o->burger_count > 0) {
+      *orders = (struct journal_order *)realloc(*orders, sizeof(*o) * (*count + 1));
+      (*orders)[(*count)++] = *o;
+    } else {
+      free(o->types);
+    }
+    free(o);
+  }
+  free(open);
+}
+
+/// @brief make a rename in the directory of @a path durable
+static void sync_dir(const char *path)
+{
+  char *copy = strdup(path);
+  int fd = open(dirname(copy), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+  if (fd >= 0) {
+    fsync(fd);
+    close(fd);
+  }
+  free(copy);
+}
+
+/// @brief write a fresh journal that contains only @a orders (as JOURNAL_ORDER records) next to
+///        @a j->path, make it durable and atomically replace the old file with it. On success
+///        @a j refers to the new file; the caller releases the old mapping and descriptor.
+/// @retval 0 on success
+/// @retval -1 error, errno contains error code, @a j is unchanged
+static int journal_rewrite(struct journal *j, const struct journal_order *orders,
+                           unsigned int count)
+{
+  size_t size = JOURNAL_INITIAL_SIZE, tail = sizeof(journal_magic);
+  char *tmp, *base = MAP_FAILED;
+  unsigned int i;
+  int fd, err;
+
+  for (i = 0; i < count; i++) tail += record_len(orders[i].burger_count);
+  while (size < tail) size <<= 1;
+
+  if (asprintf(&tmp, "%s.tmp", j->path) < 0) return -1;
+  fd = open(tmp, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if ((fd < 0) || (ftruncate(fd, size) < 0)) goto error;
+
+  base = (char *)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) goto error;
+
+  memcpy(base, journal_magic, sizeof(journal_magic));
+  tail = sizeof(journal_magic);
+  for (i = 0; i < count; i++) {
+    tail += record_put(base, tail, JOURNAL_ORDER, orders[i].customerID, orders[i].types,
+                       orders[i].burger_count);
+  }
+
+  if ((fdatasync(fd) < 0) || (rename(tmp, j->path) < 0)) goto error;
+  sync_dir(j->path);
+  free(tmp);
+
+  j->fd = fd;
+  j->base = base;
+  j->size = size;
+  j->tail = tail;
+  return 0;
+
+error:
+  err = errno;
+  if (base != MAP_FAILED) munmap(base, size);
+  if (fd >= 0) close(fd);
+  unlink(tmp);
+  free(tmp);
+  errno = err;
+  return -1;
+}
+
+/// @brief replace the journal by one that contains only its incomplete requests, unless another
+///        appender did so while we waited. Called with @a j->lock held. Appended records stay
+///        recoverable and committed ones durable, and LSNs handed out before keep their meaning.
+/// @param need size of the record about to be appended
+static void journal_compact(struct journal *j, size_t need)
+{
+  struct journal_order *orders = NULL;
+  unsigned int count = 0, next_id = 0, i;
+  size_t lsn, old_size;
+  char *old_base;
+  int old_fd;
+
+  // a leader runs fdatasync() on the current file without holding the lock
+  while (j->syncing) lockstat_cond_wait(&j->synced_cond, &j->lock);
+  if (j->tail + need <= j->compact_at) return;
+
+  lsn = j->lsn_base + j->tail;
+  old_size = j->size;
+  old_base = j->base;
+  old_fd = j->fd;
+
+  journal_scan(j->base, j->tail, &orders, &count, &next_id);
+
+  if (journal_rewrite(j, orders, count) < 0) {
+    perror("journal: compact");
+  } else {
+    munmap(old_base, old_size);
+    close(old_fd);
+
+    // everything appended so far is in the new, synced file
+    j->lsn_base = lsn - j->tail;
+    j->synced = lsn;
+    j->compactions++;
+    pthread_cond_broadcast(&j->synced_cond);
+  }
+
+  // live requests that fill half of the threshold would make every append compact again
+  j->compact_at = JOURNAL_COMPACT_SIZE;
+  while (j->compact_at < 2 * (j->tail + need)) j->compact_at <<= 1;
+
+  for (i = 0; i < count; i++) free(orders[i].types);
+  free(orders);
+}
+/// @endinternal
+
+int journal_open(struct journal *j, const char *path)
+{
+  struct stat st;
+  void *base;
+  int fd;
+
+  memset(j, 0, sizeof(*j));
+  j->fd = -1;
+
+  // recover the incomplete requests of the previous run
+  fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd >= 0) {
+    if ((fstat(fd, &st) == 0) && (st.st_size > 0)) {
+      base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (base != MAP_FAILED) {
+        journal_scan((const char *)base, st.st_size, &j->recovered, &j->recovered_count,
+                     &j->next_id);
+        munmap(base, st.st_size);
+      }
+    }
+    close(fd);
+  } else if (errno != ENOENT) {
+    return -1;
+  }
+
+  j->path = strdup(path);
+  if (journal_rewrite(j, j->recovered, j->recovered_count) < 0) {
+    free(j->path);
+    j->path = NULL;
+    return -1;
+  }
+
+  j->synced = j->tail;
+  j->compact_at = JOURNAL_COMPACT_SIZE;
+  lockstat_init(&j->lock, journal);
+  pthread_cond_init(&j->synced_cond, NULL);
+
+  return 0;
+}
+
+void journal_close(struct journal *j)
+{
+  unsigned int i;
+
+  if (j->fd < 0) return;
+
+  journal_commit(j, journal_lsn(j));
+  munmap(j->base, j->size);
+  close(j->fd);
+  j->fd = -1;
+  free(j->path);
+  j->path = NULL;
+
+  for (i = 0; i < j->recovered_count; i++) free(j->recovered[i].types);
+  free(j->recovered);
+  j->recovered = NULL;
+  j->recovered_count = 0;
+
+  pthread_cond_destroy(&j->synced_cond);
+  lockstat_destroy(&j->lock);
+}
+
+size_t journal_append(struct journal *j, enum journal_kind kind, unsigned int customerID,
+                      const enum burger_type *types, unsigned int burger_count)
+{
+  size_t lsn;
+
+  lockstat_lock(&j->lock);
+  if (j->tail + record_len(burger_count) > j->compact_at) {
+    journal_compact(j, record_len(burger_count));
+  }
+  lsn = journal_write(j, kind, customerID, types, burger_count);
+  lockstat_unlock(&j->lock);
+
+  return lsn;
+}
+
+void journal_commit(struct journal *j, size_t lsn)
+{
+  size_t target;
+
+  lockstat_lock(&j->lock);
+  j->commits++;
+  while (j->synced < lsn) {
+    if (j->syncing) {
+      // another committer's sync may already cover our records
+      lockstat_cond_wait(&j->synced_cond, &j->lock);
+      continue;
+    }
+
+    // become the leader and sync everything appended so far on behalf of the whole group
+    j->syncing = 1;
+    target = j->lsn_base + j->tail;
+    lockstat_unlock(&j->lock);
+
+    fdatasync(j->fd);
+
+    lockstat_lock(&j->lock);
+    j->synced = target;
+    j->syncing = 0;
+    j->syncs++;
+    pthread_cond_broadcast(&j->synced_cond);
+  }
+  lockstat_unlock(&j->lock);
+}
+
+size_t journal_lsn(struct journal *j)
+{
+  size_t lsn;
+
+  lockstat_lock(&j->lock);
+  lsn = j->lsn_base + j->tail;
+  lockstat_unlock(&j->lock);
+
+  return lsn;
+}
@@ -0,0 +1,139 @@
+//--------------------------------------------------------------------------------------------------
+// Network Lab                             Spring 2024                           System Programming
+//
+/// @file  journal.h
+/// @brief write-ahead order journal: append-only, memory-mapped log with group commit
+///
+/// @section changelog Change Log
+/// 2026/10/18 ARC lab created
+///
+/// @section license_section License
+/// Copyright (c) 2024-2026, Architecture and Code Optimization Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS  BE LIABLE FOR ANY DIRECT,  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY,  OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS; OR BUSINESS INTERRUPTION)  HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#ifndef __JOURNAL_H__
+#define __JOURNAL_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "burger.h"
+#include "lockstat.h"
+
+/// @name Constant definitions
+/// @{
+
+#define JOURNAL_INITIAL_SIZE (1 << 20)                      ///< initial journal file size (bytes)
+#define JOURNAL_COMPACT_SIZE (16 << 20)                     ///< compaction threshold (bytes)
+
+/// @}
+
+/// @name Structures
+/// @{
+
+/// @brief kind of a journal record
+enum journal_kind {
+  JOURNAL_ORDER = 1,                                        ///< burger types of a request accepted
+  JOURNAL_BURGER,                                           ///< one burger of a request made
+  JOURNAL_DONE,                                             ///< request finished, nothing left
+};
+
+/// @brief incomplete request found when the journal was opened
+struct journal_order {
+  unsigned int customerID;                                  ///< customer ID
+  unsigned int burger_count;                                ///< number of burgers still to make
+  enum burger_type *types;                                  ///< burgers still to make
+};
+
+/// @brief open journal. Records are appended under @a lock; journal_commit() makes them durable
+///        with one fdatasync() per group of concurrent committers. Log sequence numbers count the
+///        bytes appended since the journal was opened and keep growing across compactions.
+struct journal {
+  char *path;                                               ///< journal file name
+  int fd;                                                   ///< journal file
+  char *base;                                               ///< mapped journal file
+  size_t size;                                              ///< size of file and mapping
+  size_t tail;                                              ///< end of the last appended record
+  size_t lsn_base;                                          ///< log sequence number of offset 0
+  size_t synced;                                            ///< LSN of the last durable record
+  size_t compact_at;                                        ///< @a tail that triggers compaction
+  int syncing;                                              ///< a committer is running fdatasync()
+  lockstat_mutex_t lock;                                    ///< protects the fields above
+  pthread_cond_t synced_cond;                               ///< signalled when @a synced advances
+  unsigned long records;                                    ///< number of appended records
+  unsigned long commits;                                    ///< number of journal_commit() calls
+  unsigned long syncs;                                      ///< number of fdatasync() calls
+  unsigned long compactions;                                ///< compactions while open
+  unsigned int next_id;                                     ///< first customer ID not in journal
+  struct journal_order *recovered;                          ///< incomplete requests at open time
+  unsigned int recovered_count;                             ///< number of entries in @a recovered
+};
+
+/// @}
+
+/// @name journal operations
+/// @{
+
+/// @brief open the journal at @a path and collect the requests that were accepted but not finished
+///        in @a j->recovered. The journal is then compacted: a fresh file that contains only the
+///        recovered requests (as JOURNAL_ORDER records of their remaining burgers) atomically
+///        replaces the old one, so the log does not grow across restarts.
+/// @param j journal to initialize
+/// @param path journal file (created if it does not exist)
+/// @retval 0 on success
+/// @retval -1 error, errno contains error code
+int journal_open(struct journal *j, const char *path);
+
+/// @brief make all records durable, unmap and close the journal and free @a j->recovered.
+/// @param j journal
+void journal_close(struct journal *j);
+
+/// @brief append a record. The record is visible to a later journal_open() once the process
+///        exits, but only durable across a system crash after journal_commit(). When the file
+///        reaches JOURNAL_COMPACT_SIZE it is compacted first, like in journal_open(), so that
+///        it does not grow without bound during a long run.
+/// @param j journal
+/// @param kind record kind
+/// @param customerID customer ID
+/// @param types burger types (JOURNAL_ORDER: all of the request or of one batch of a stream,
+///              JOURNAL_BURGER: the one made)
+/// @param burger_count number of entries in @a types (0 for JOURNAL_DONE)
+/// @retval log sequence number to pass to journal_commit()
+size_t journal_append(struct journal *j, enum journal_kind kind, unsigned int customerID,
+                      const enum burger_type *types, unsigned int burger_count);
+
+/// @brief wait until every record up to @a lsn is durable. Concurrent committers are batched:
+///        the first one issues fdatasync() for everything appended so far while the others wait
+///        for it, so N concurrent commits cost one sync instead of N.
+/// @param j journal
+/// @param lsn log sequence number returned by journal_append() or journal_lsn()
+void journal_commit(struct journal *j, size_t lsn);
+
+/// @brief log sequence number of the last appended record
+/// @param j journal
+size_t journal_lsn(struct journal *j);
+
+/// @}
+
+#endif // __JOURNAL_H__
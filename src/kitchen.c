@@ -0,0 +1,247 @@
+//--------------------------------------------------------------------------------------------------
+// Network Lab                             Spring 2024                           System Programming
+//
+/// @file  kitchen.c
+/// @brief pipelined kitchen: stations with their own workers, service time and bounded queues
+///
+/// @section changelog Change Log
+/// 2026/10/18 ARC lab created
+///
+/// @section license_section License
+/// Copyright (c) 2024-2026, Architecture and Code Optimization Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS  BE LIABLE FOR ANY DIRECT,  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY,  OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS; OR BUSINESS INTERRUPTION)  HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "kitchen.h"
+
+LOCKSTAT_CLASS(station);                                    ///< `lock` of every station
+
+/// @internal
+struct station_worker {
+  struct kitchen *k;                                        ///< kitchen
+  unsigned int index;                                       ///< station of the worker
+};
+
+static uint64_t now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void sleep_ms(unsigned int ms)
+{
+  struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+
+  while (nanosleep(&ts, &ts) != 0) ;
+}
+
+/// @brief take the oldest order from the input queue of @a s, waiting if it is empty
+static void *station_pop(struct station *s)
+{
+  struct station_slot *slot;
+  void *item;
+
+  lockstat_lock(&s->lock);
+  while (s->count == 0) lockstat_cond_wait(&s->nonempty, &s->lock);
+
+  slot = &s->queue[s->head];
+  item = slot->item;
+  s->wait_ns += now_ns() - slot->enqueued;
+  s->head = (s->head + 1) % s->capacity;
+  s->count--;
+
+  pthread_cond_signal(&s->nonfull);
+  lockstat_unlock(&s->lock);
+
+  return item;
+}
+
+/// @brief append an order to the input queue of @a s, waiting while it is full
+/// @retval time spent waiting for space (ns)
+static uint64_t station_push(struct station *s, void *item)
+{
+  struct station_slot *slot;
+  uint64_t start = now_ns(), now = start;
+
+  lockstat_lock(&s->lock);
+  if (s->count == s->capacity) {
+    while (s->count == s->capacity) lockstat_cond_wait(&s->nonfull, &s->lock);
+    now = now_ns();
+  }
+
+  slot = &s->queue[(s->head + s->count) % s->capacity];
+  slot->item = item;
+  slot->enqueued = now;
+  s->count++;
+
+  pthread_cond_signal(&s->nonempty);
+  lockstat_unlock(&s->lock);
+
+  return now - start;
+}
+
+/// @brief worker thread of a station: take an order, process it for the station's service time
+///        and pass it on to the next station, or finish it at the last one
+static void *station_task(void *data)
+{
+  struct station_worker *w = (struct station_worker *)data;
+  struct kitchen *k = w->k;
+  struct station *s = &k->station[w->index];
+  uint64_t start, busy, blocked = 0;
+  void *item;
+
+  while (1) {
+    if (w->index == 0) {
+      item = k->source();
+      if (item == NULL) {
+        if (!*k->running) break;
+        sleep_ms(KITCHEN_IDLE_MS);
+        continue;
+      }
+    } else {
+      item = station_pop(s);
+    }
+
+    start = now_ns();
+    sleep_ms(s->service_ms);
+    busy = now_ns() - start;
+
+    if (w->index + 1 < k->nstations) blocked = station_push(&k->station[w->index + 1], item);
+    else k->finish(item);
+
+    lockstat_lock(&s->lock);
+    s->items++;
+    s->busy_ns += busy;
+    s->blocked_ns += blocked;
+    lockstat_unlock(&s->lock);
+  }
+
+  free(w);
+  return NULL;
+}
+
+int kitchen_parse(struct kitchen *k, const char *spec)
+{
+  struct station *s;
+  unsigned int workers, service_ms, capacity;
+  char name[16];
+  int n, len;
+
+  while (*spec != '\0') {
+    if (k->nstations == KITCHEN_STATIONS_MAX) return -1;
+
+    capacity = KITCHEN_QUEUE_DEFAULT;
+    n = sscanf(spec, "%15[^:,]:%u:%u%n:%u%n", name, &workers, &service_ms, &len, &capacity, &len);
+    if ((n < 3) || (workers == 0) || (capacity == 0)) return -1;
+    spec += len;
+    if (*spec == ',') spec++;
+    else if (*spec != '\0') return -1;
+
+    s = &k->station[k->nstations++];
+    memset(s, 0, sizeof(*s));
+    strcpy(s->name, name);
+    s->workers = workers;
+    s->service_ms = service_ms;
+    s->capacity = capacity;
+  }
+
+  return k->nstations > 0 ? 0 : -1;
+}
+
+int kitchen_start(struct kitchen *k, void *(*source)(void), void (*finish)(void *item),
+                  volatile sig_atomic_t *running)
+{
+  struct station_worker *w;
+  struct station *s;
+  pthread_t tid;
+
+  k->source = source;
+  k->finish = finish;
+  k->running = running;
+  k->started = now_ns();
+
+  for (unsigned int i = 0; i < k->nstations; i++) {
+    s = &k->station[i];
+    lockstat_init(&s->lock, station);
+    pthread_cond_init(&s->nonempty, NULL);
+    pthread_cond_init(&s->nonfull, NULL);
+    if (i > 0) s->queue = (struct station_slot *)malloc(sizeof(struct station_slot) * s->capacity);
+  }
+
+  for (unsigned int i = 0; i < k->nstations; i++) {
+    for (unsigned int j = 0; j < k->station[i].workers; j++) {
+      w = (struct station_worker *)malloc(sizeof(struct station_worker));
+      w->k = k;
+      w->index = i;
+      if (pthread_create(&tid, NULL, station_task, w) != 0) {
+        free(w);
+        return -1;
+      }
+      pthread_detach(tid);
+    }
+  }
+
+  return 0;
+}
+
+uint64_t kitchen_estimate(const struct kitchen *k, unsigned int orders)
+{
+  uint64_t latency = 0, interval = 0, t;
+
+  for (unsigned int i = 0; i < k->nstations; i++) {
+    t = (uint64_t)k->station[i].service_ms * 1000000ULL;
+    latency += t;
+    if (t / k->station[i].workers > interval) interval = t / k->station[i].workers;
+  }
+
+  return latency + (orders - 1) * interval;
+}
+
+void kitchen_print_stats(struct kitchen *k)
+{
+  struct station *s;
+  double elapsed = (now_ns() - k->started) * 1e-9;
+
+  printf("%-12s %7s %10s %8s %10s %8s %12s\n", "station", "workers", "service_ms", "items",
+         "util", "queue", "wait_ms");
+  for (unsigned int i = 0; i < k->nstations; i++) {
+    s = &k->station[i];
+    lockstat_lock(&s->lock);
+    printf("%-12s %7u %10u %8lu %9.1f%% ", s->name, s->workers, s->service_ms, s->items,
+           s->busy_ns * 1e-7 / (elapsed * s->workers));
+    // the first station is fed by the source, which has no queue of its own here
+    if (i == 0) printf("%8s %12s\n", "-", "-");
+    else printf("%8u %12.3f\n", s->count, s->items ? s->wait_ns * 1e-6 / s->items : 0.0);
+    if (s->blocked_ns > 0) {
+      printf("%-12s blocked %.3f s by the next station (backpressure)\n", "", s->blocked_ns * 1e-9);
+    }
+    lockstat_unlock(&s->lock);
+  }
+}
@@ -0,0 +1,131 @@
+//--------------------------------------------------------------------------------------------------
+// Network Lab                             Spring 2024                           System Programming
+//
+/// @file  kitchen.h
+/// @brief pipelined kitchen: stations with their own workers, service time and bounded queues
+///
+/// @section changelog Change Log
+/// 2026/10/18 ARC lab created
+///
+/// @section license_section License
+/// Copyright (c) 2024-2026, Architecture and Code Optimization Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS  BE LIABLE FOR ANY DIRECT,  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY,  OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS; OR BUSINESS INTERRUPTION)  HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+
+#ifndef __KITCHEN_H__
+#define __KITCHEN_H__
+
+#include <stdint.h>
+#include <signal.h>
+#include <pthread.h>
+
+#include "lockstat.h"
+
+/// @name Constant definitions
+/// @{
+
+#define KITCHEN_STATIONS_MAX 8                              ///< maximum number of stations
+#define KITCHEN_QUEUE_DEFAULT 8                             ///< default bound of a station queue
+#define KITCHEN_IDLE_MS 100                                 ///< first station's idle poll interval
+
+/// @}
+
+/// @name Structures
+/// @{
+
+/// @brief entry of a station's input queue
+struct station_slot {
+  void *item;                                               ///< order
+  uint64_t enqueued;                                        ///< time the order was queued (ns)
+};
+
+/// @brief one station of the kitchen. The first station takes orders from the kitchen's source;
+///        every other station takes them from its bounded input queue, which is filled by the
+///        previous station. A worker that finds the next queue full waits (backpressure), so a
+///        slow station throttles the stations before it instead of letting orders pile up.
+struct station {
+  char name[16];                                            ///< station name
+  unsigned int workers;                                     ///< number of worker threads
+  unsigned int service_ms;                                  ///< time to process one order
+  unsigned int capacity;                                    ///< bound of the input queue
+  struct station_slot *queue;                               ///< input queue (NULL for station 0)
+  unsigned int head;                                        ///< index of the oldest queued order
+  unsigned int count;                                       ///< number of queued orders
+  lockstat_mutex_t lock;                                    ///< protects queue and statistics
+  pthread_cond_t nonempty;                                  ///< signalled when an order is queued
+  pthread_cond_t nonfull;                                   ///< signalled when an order is taken
+  unsigned long items;                                      ///< orders processed
+  uint64_t busy_ns;                                         ///< total service time of all workers
+  uint64_t wait_ns;                                         ///< total time orders waited in queue
+  uint64_t blocked_ns;                                      ///< total time workers waited for space
+};
+
+/// @brief a pipeline of stations. Orders are fetched by the first station with @a source and
+///        handed to @a finish by the worker of the last station that processed them.
+struct kitchen {
+  unsigned int nstations;                                   ///< number of stations
+  struct station station[KITCHEN_STATIONS_MAX];             ///< stations in processing order
+  void *(*source)(void);                                    ///< next order, NULL if none
+  void (*finish)(void *item);                               ///< completes an order
+  volatile sig_atomic_t *running;                           ///< stop fetching orders once cleared
+  uint64_t started;                                         ///< time the kitchen started (ns)
+};
+
+/// @}
+
+/// @name kitchen operations
+/// @{
+
+/// @brief add the stations described by @a spec to @a k. @a spec is a comma-separated list of
+///        `name:workers:service_ms[:queue]`, e.g. "grill:4:400,assemble:2:300,wrap:2:300".
+/// @param k kitchen (zero-initialized before the first call)
+/// @param spec station list
+/// @retval 0 on success
+/// @retval -1 if @a spec is malformed or has too many stations
+int kitchen_parse(struct kitchen *k, const char *spec);
+
+/// @brief start the worker threads of all stations
+/// @param k kitchen with at least one station
+/// @param source returns the next order, or NULL if there is none
+/// @param finish called by the last station for every processed order
+/// @param running the first station stops fetching orders once *@a running is 0 and none is left
+/// @retval 0 on success
+/// @retval -1 if a thread could not be created
+int kitchen_start(struct kitchen *k, void *(*source)(void), void (*finish)(void *item),
+                  volatile sig_atomic_t *running);
+
+/// @brief estimate the time to process @a orders orders that are queued before the kitchen:
+///        the latency of one order through all stations plus the remaining orders at the rate of
+///        the bottleneck station.
+/// @param k kitchen
+/// @param orders number of orders (> 0)
+/// @retval estimated time in ns
+uint64_t kitchen_estimate(const struct kitchen *k, unsigned int orders);
+
+/// @brief print per-station utilization, mean queue wait and backpressure
+/// @param k kitchen
+void kitchen_print_stats(struct kitchen *k);
+
+/// @}
+
+#endif // __KITCHEN_H__
@@ -0,0 +1,273 @@
+//--------------------------------------------------------------------------------------------------
+// Network Lab                             Spring 2024                           System Programming
+//
+/// @file  lockstat.c
+/// @brief instrumented mutexes (compiled only with -DLOCKSTAT)
+///
+/// @section changelog Change Log
+/// 2026/10/18 ARC lab created
+///
+/// @section license_section License
+/// Copyright (c) 2024-2026, Architecture and Code Optimization Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS  BE LIABLE FOR ANY DIRECT,  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY,  OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS; OR BUSINESS INTERRUPTION)  HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "lockstat.h"
+
+#ifdef LOCKSTAT
+
+static struct lockstat_class *classes;                      ///< registered lock classes
+static pthread_mutex_t classes_lock = PTHREAD_MUTEX_INITIALIZER; ///< protects @a classes
+
+/// @internal
+#define add(p, v) __atomic_fetch_add((p), (v), __ATOMIC_RELAXED)
+#define load(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+
+/// @brief current time of CLOCK_MONOTONIC in nanoseconds
+static uint64_t now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/// @brief histogram bucket of a duration of @a ns nanoseconds
+static unsigned int bucket(uint64_t ns)
+{
+  unsigned int b = 0;
+
+  for (ns >>= 8; (ns > 0) && (b < LOCKSTAT_BUCKETS - 1); ns >>= 1) b++;
+  return b;
+}
+
+/// @brief raise @a *max to @a v
+static void update_max(uint64_t *max, uint64_t v)
+{
+  uint64_t cur = load(max);
+
+  while ((v > cur) &&
+         !__atomic_compare_exchange_n(max, &cur, v, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) ;
+}
+
+/// @brief list @a cls in the report on its first acquisition
+static void register_class(struct lockstat_class *cls)
+{
+  pthread_mutex_lock(&classes_lock);
+  if (!cls->registered) {
+    cls->next = classes;
+    classes = cls;
+    __atomic_store_n(&cls->registered, 1, __ATOMIC_RELEASE);
+  }
+  pthread_mutex_unlock(&classes_lock);
+}
+
+/// @brief find or claim the slot of call site @a file:@a line. Sites beyond LOCKSTAT_SITES are
+///        not tracked.
+static struct lockstat_site *find_site(struct lockstat_class *cls, const char *file, int line)
+{
+  uint64_t key = ((uint64_t)line << 48) | (uintptr_t)file, cur;
+  unsigned int i, slot = (unsigned int)((key ^ (key >> 29)) * 0x9e3779b1u) % LOCKSTAT_SITES;
+
+  for (i = 0; i < LOCKSTAT_SITES; i++, slot = (slot + 1) % LOCKSTAT_SITES) {
+    cur = load(&cls->sites[slot].key);
+    if (cur == key) return &cls->sites[slot];
+    if ((cur == 0) && __atomic_compare_exchange_n(&cls->sites[slot].key, &cur, key, 0,
+                                                  __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+      return &cls->sites[slot];
+    }
+    if (cur == key) return &cls->sites[slot];
+  }
+
+  return NULL;
+}
+
+/// @brief account an acquisition of @a m from @a file:@a line that waited @a wait_ns
+static void acquired(lockstat_mutex_t *m, const char *file, int line, bool contended,
+                     uint64_t wait_ns)
+{
+  struct lockstat_class *cls = m->cls;
+  struct lockstat_site *site = find_site(cls, file, line);
+
+  if (!__atomic_load_n(&cls->registered, __ATOMIC_ACQUIRE)) register_class(cls);
+
+  add(&cls->acquisitions, 1);
+  if (site != NULL) add(&site->acquisitions, 1);
+
+  if (contended) {
+    add(&cls->contended, 1);
+    add(&cls->wait_ns, wait_ns);
+    add(&cls->wait[bucket(wait_ns)], 1);
+    update_max(&cls->wait_max_ns, wait_ns);
+    if (site != NULL) {
+      add(&site->contended, 1);
+      add(&site->wait_ns, wait_ns);
+    }
+  }
+}
+
+/// @brief account the hold time of @a m, which is about to be released
+static void released(lockstat_mutex_t *m)
+{
+  struct lockstat_class *cls = m->cls;
+  uint64_t hold_ns = now_ns() - m->acquired;
+
+  add(&cls->holds, 1);
+  add(&cls->hold_ns, hold_ns);
+  add(&cls->hold[bucket(hold_ns)], 1);
+  update_max(&cls->hold_max_ns, hold_ns);
+}
+/// @endinternal
+
+void lockstat_init_class(lockstat_mutex_t *m, struct lockstat_class *cls)
+{
+  pthread_mutex_init(&m->mutex, NULL);
+  m->cls = cls;
+  m->acquired = 0;
+}
+
+void lockstat_lock_at(lockstat_mutex_t *m, const char *file, int line)
+{
+  uint64_t start;
+
+  // only a failed trylock costs a clock read for the wait time
+  if (pthread_mutex_trylock(&m->mutex) == 0) {
+    m->acquired = now_ns();
+    acquired(m, file, line, false, 0);
+    return;
+  }
+
+  start = now_ns();
+  pthread_mutex_lock(&m->mutex);
+  m->acquired = now_ns();
+  acquired(m, file, line, true, m->acquired - start);
+}
+
+int lockstat_trylock_at(lockstat_mutex_t *m, const char *file, int line)
+{
+  int res = pthread_mutex_trylock(&m->mutex);
+
+  if (res == 0) {
+    m->acquired = now_ns();
+    acquired(m, file, line, false, 0);
+  }
+  return res;
+}
+
+void lockstat_unlock_at(lockstat_mutex_t *m)
+{
+  released(m);
+  pthread_mutex_unlock(&m->mutex);
+}
+
+int lockstat_cond_timedwait_at(pthread_cond_t *cond, lockstat_mutex_t *m,
+                               const struct timespec *abstime)
+{
+  int res;
+
+  released(m);
+  if (abstime != NULL) res = pthread_cond_timedwait(cond, &m->mutex, abstime);
+  else res = pthread_cond_wait(cond, &m->mutex);
+  m->acquired = now_ns();
+
+  return res;
+}
+
+/// @internal
+/// @brief print @a ns with a unit
+static void print_time(FILE *f, uint64_t ns)
+{
+  if (ns < 1000) fprintf(f, "%luns", ns);
+  else if (ns < 1000000) fprintf(f, "%.1fus", ns * 1e-3);
+  else fprintf(f, "%.1fms", ns * 1e-6);
+}
+
+/// @brief print the non-empty buckets of histogram @a hist
+static void print_histogram(FILE *f, const char *label, const uint64_t *hist)
+{
+  unsigned int i;
+
+  fprintf(f, "  %s:", label);
+  for (i = 0; i < LOCKSTAT_BUCKETS; i++) {
+    if (hist[i] == 0) continue;
+    fprintf(f, (i < LOCKSTAT_BUCKETS - 1) ? " <" : " >=");
+    print_time(f, (i < LOCKSTAT_BUCKETS - 1) ? 256ULL << i : 256ULL << (i - 1));
+    fprintf(f, " %lu", hist[i]);
+  }
+  fprintf(f, "\n");
+}
+
+/// @brief order call sites by wait time, then by acquisitions
+static int compare_sites(const void *a, const void *b)
+{
+  const struct lockstat_site *x = (const struct lockstat_site *)a;
+  const struct lockstat_site *y = (const struct lockstat_site *)b;
+
+  if (x->wait_ns != y->wait_ns) return x->wait_ns < y->wait_ns ? 1 : -1;
+  if (x->acquisitions != y->acquisitions) return x->acquisitions < y->acquisitions ? 1 : -1;
+  return 0;
+}
+/// @endinternal
+
+void lockstat_print(FILE *f)
+{
+  struct lockstat_site sites[LOCKSTAT_SITES];
+  struct lockstat_class *cls;
+  const char *file;
+  unsigned int i;
+
+  pthread_mutex_lock(&classes_lock);
+  for (cls = classes; cls != NULL; cls = cls->next) {
+    fprintf(f, "Lock %s: %lu acquisitions, %lu contended (%.2f%%), wait avg ", cls->name,
+            cls->acquisitions, cls->contended,
+            cls->acquisitions ? 100.0 * cls->contended / cls->acquisitions : 0.0);
+    print_time(f, cls->contended ? cls->wait_ns / cls->contended : 0);
+    fprintf(f, " max ");
+    print_time(f, cls->wait_max_ns);
+    fprintf(f, ", hold avg ");
+    print_time(f, cls->holds ? cls->hold_ns / cls->holds : 0);
+    fprintf(f, " max ");
+    print_time(f, cls->hold_max_ns);
+    fprintf(f, "\n");
+    if (cls->contended > 0) print_histogram(f, "wait", cls->wait);
+    print_histogram(f, "hold", cls->hold);
+
+    memcpy(sites, cls->sites, sizeof(sites));
+    qsort(sites, LOCKSTAT_SITES, sizeof(sites[0]), compare_sites);
+    for (i = 0; (i < LOCKSTAT_TOP_SITES) && (sites[i].key != 0); i++) {
+      file = (const char *)(uintptr_t)(sites[i].key & ((1ULL << 48) - 1));
+      fprintf(f, "  %s:%lu: %lu acquisitions, %lu contended, waited ", file, sites[i].key >> 48,
+              sites[i].acquisitions, sites[i].contended);
+      print_time(f, sites[i].wait_ns);
+      fprintf(f, "\n");
+    }
+  }
+  pthread_mutex_unlock(&classes_lock);
+}
+
+#endif // LOCKSTAT
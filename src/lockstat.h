@@ -0,0 +1,142 @@
+//--------------------------------------------------------------------------------------------------
+// Network Lab                             Spring 2024                           System Programming
+//
+/// @file  lockstat.h
+/// @brief instrumented mutexes: acquisitions, contention, wait/hold histograms and call sites
+///
+/// @section changelog Change Log
+/// 2026/10/18 ARC lab created
+///
+/// @section license_section License
+/// Copyright (c) 2024-2026, Architecture and Code Optimization Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS  BE LIABLE FOR ANY DIRECT,  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY,  OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS; OR BUSINESS INTERRUPTION)  HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+
+#ifndef __LOCKSTAT_H__
+#define __LOCKSTAT_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+
+/// @name Lock profiling
+/// Mutexes are declared as lockstat_mutex_t and used through the lockstat_*() macros. Built with
+/// -DLOCKSTAT (`make LOCKSTAT=1`), every mutex belongs to a lock class that counts acquisitions
+/// and contended acquisitions, keeps wait- and hold-time histograms and the call sites that take
+/// the lock. Otherwise the macros compile to the plain pthread calls.
+/// @{
+
+#ifdef LOCKSTAT
+
+#define LOCKSTAT_BUCKETS 24                                 ///< bucket 0: <256 ns, i: <2^(i+8) ns
+#define LOCKSTAT_SITES 32                                   ///< call sites tracked per class
+#define LOCKSTAT_TOP_SITES 5                                ///< call sites reported per class
+
+/// @brief call site taking a lock
+struct lockstat_site {
+  uint64_t key;                                             ///< line << 48 | file (0: free slot)
+  uint64_t acquisitions;                                    ///< acquisitions from this site
+  uint64_t contended;                                       ///< acquisitions that had to wait
+  uint64_t wait_ns;                                         ///< total wait time
+};
+
+/// @brief statistics shared by all mutexes of one class (e.g., all request mutexes)
+struct lockstat_class {
+  const char *name;                                         ///< class name
+  int registered;                                           ///< listed in the report
+  struct lockstat_class *next;                              ///< next registered class
+  uint64_t acquisitions;                                    ///< number of acquisitions
+  uint64_t contended;                                       ///< acquisitions that had to wait
+  uint64_t wait_ns, wait_max_ns;                            ///< total and longest wait
+  uint64_t holds;                                           ///< hold intervals (incl. cond waits)
+  uint64_t hold_ns, hold_max_ns;                            ///< total and longest hold
+  uint64_t wait[LOCKSTAT_BUCKETS];                          ///< wait-time histogram (contended)
+  uint64_t hold[LOCKSTAT_BUCKETS];                          ///< hold-time histogram
+  struct lockstat_site sites[LOCKSTAT_SITES];               ///< call sites (open addressing)
+};
+
+/// @brief instrumented mutex
+typedef struct {
+  pthread_mutex_t mutex;                                    ///< underlying mutex
+  struct lockstat_class *cls;                               ///< lock class
+  uint64_t acquired;                                        ///< time of the acquisition (held)
+} lockstat_mutex_t;
+
+/// @brief define lock class @a name
+#define LOCKSTAT_CLASS(name) struct lockstat_class lockstat_class_##name = { #name }
+
+/// @brief static initializer of a mutex of lock class @a name
+#define LOCKSTAT_MUTEX_INITIALIZER(name) { PTHREAD_MUTEX_INITIALIZER, &lockstat_class_##name, 0 }
+
+#define lockstat_init(m, name) lockstat_init_class((m), &lockstat_class_##name)
+#define lockstat_destroy(m) pthread_mutex_destroy(&(m)->mutex)
+#define lockstat_lock(m) lockstat_lock_at((m), __FILE__, __LINE__)
+#define lockstat_trylock(m) lockstat_trylock_at((m), __FILE__, __LINE__)
+#define lockstat_unlock(m) lockstat_unlock_at(m)
+#define lockstat_cond_wait(c, m) lockstat_cond_timedwait_at((c), (m), NULL)
+#define lockstat_cond_timedwait(c, m, t) lockstat_cond_timedwait_at((c), (m), (t))
+
+/// @brief initialize mutex @a m of lock class @a cls
+void lockstat_init_class(lockstat_mutex_t *m, struct lockstat_class *cls);
+
+/// @brief lock @a m and account the acquisition to the call site @a file:@a line
+void lockstat_lock_at(lockstat_mutex_t *m, const char *file, int line);
+
+/// @brief try to lock @a m without waiting (see pthread_mutex_trylock())
+/// @retval 0 if @a m has been locked
+/// @retval EBUSY if @a m is held
+int lockstat_trylock_at(lockstat_mutex_t *m, const char *file, int line);
+
+/// @brief unlock @a m and account its hold time
+void lockstat_unlock_at(lockstat_mutex_t *m);
+
+/// @brief wait on @a cond (until @a abstime unless NULL). The time spent waiting does not count
+///        as hold time, and reacquiring @a m after the wait does not count as an acquisition.
+/// @retval return value of pthread_cond_timedwait() or pthread_cond_wait()
+int lockstat_cond_timedwait_at(pthread_cond_t *cond, lockstat_mutex_t *m,
+                               const struct timespec *abstime);
+
+/// @brief print the statistics of every lock class that has been taken to @a f
+void lockstat_print(FILE *f);
+
+#else
+
+typedef pthread_mutex_t lockstat_mutex_t;
+
+#define LOCKSTAT_CLASS(name) extern int lockstat_unused_##name
+#define LOCKSTAT_MUTEX_INITIALIZER(name) PTHREAD_MUTEX_INITIALIZER
+
+#define lockstat_init(m, name) pthread_mutex_init((m), NULL)
+#define lockstat_destroy(m) pthread_mutex_destroy(m)
+#define lockstat_lock(m) pthread_mutex_lock(m)
+#define lockstat_trylock(m) pthread_mutex_trylock(m)
+#define lockstat_unlock(m) pthread_mutex_unlock(m)
+#define lockstat_cond_wait(c, m) pthread_cond_wait((c), (m))
+#define lockstat_cond_timedwait(c, m, t) pthread_cond_timedwait((c), (m), (t))
+#define lockstat_print(f) ((void)0)
+
+#endif // LOCKSTAT
+
+/// @}
+
+#endif // __LOCKSTAT_H__
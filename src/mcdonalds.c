@@ -41,41 +41,76 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <signal.h>
 #include <pthread.h>
 #include <errno.h>
+#include <time.h>
+#include <poll.h>
 
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <netdb.h>
+#include <sys/eventfd.h>
 
 #include "net.h"
+#include "uring.h"
+#include "shm.h"
+#include "request.h"
+#include "journal.h"
+#include "stats.h"
+#include "kitchen.h"
+#include "trace.h"
+#include "lockstat.h"
 #include "burger.h"
 
+/// @name Constant definitions
+/// @{
+
+#define HANGUP_CHECK_MS 100                                 ///< customer hangup polling interval
+#define BURGER_COOK_SEC 1                                   ///< kitchen time of one make_burger()
+#define DEADLINE_NONE UINT64_MAX                            ///< EDF key without a deadline
+#define SERVE_STACK_SIZE (256 * 1024)                       ///< stack size of a serving thread
+#define STREAM_BATCH 16                                     ///< burgers per batch of a stream
+#define STREAM_WINDOW 4                                     ///< batches of a stream in the kitchen
+#define STREAM_CHUNK 4096                                   ///< bytes of a stream read at a time
+#define STREAM_TOKEN_MAX 32                                 ///< longest token carried over a read
+
+/// @}
+
 /// @name Structures
 /// @{
 
-/// @brief general node element to implement a singly-linked list
+/// @brief order element of the OrderList heap
 typedef struct __node {
-  struct __node *next;                                      ///< pointer to next node
+  uint64_t deadline;                                        ///< EDF key: absolute deadline (ns)
+  unsigned long seq;                                        ///< arrival order, breaks deadline ties
+  unsigned int heap_index;                                  ///< position in the heap while queued
+  bool queued;                                              ///< in the OrderList (not yet dequeued)
+  bool has_deadline;                                        ///< deadline requested by the customer
   unsigned int customerID;                                  ///< customer ID that requested
   enum burger_type type;                                    ///< requested burger type
   pthread_cond_t *cond;                                     ///< conditional variable
-  pthread_mutex_t *cond_mutex;                              ///< mutex variable for conditional variable
-  char **order_str;                                         ///< pointer of string to be made by kitchen
+  lockstat_mutex_t *cond_mutex;                             ///< mutex for conditional variable
+  enum burger_type *made;                                   ///< burgers made, shared by request
   unsigned int *remain_count;                               ///< number of remaining burgers
-  //
-  // TODO: Add more variables if needed
-  //
+  void *notify;                                             ///< io_uring connection or NULL
+  struct __node *dl_left, *dl_right;                        ///< children in the deadline index
+  unsigned int dl_prio;                                     ///< deadline index treap priority
+  unsigned int dl_count;                                    ///< orders in this deadline subtree
+  uint64_t dl_work;                                         ///< cook time of this deadline subtree
 } Node;
 
-/// @brief order data
+/// @brief order data: binary min-heap of Nodes, earliest deadline first
 typedef struct __order_list {
-  Node *head;                                               ///< head of order list
-  Node *tail;                                               ///< tail of order list
+  Node **heap;                                              ///< heap array
+  unsigned int capacity;                                    ///< allocated entries of heap
   unsigned int count;                                       ///< number of nodes in list
+  unsigned long seq;                                        ///< arrival counter
+  Node *deadlines;                                          ///< deadline index of queued orders
 } OrderList;
 
 /// @brief structure for server context
@@ -83,334 +118,2016 @@ struct mcdonalds_ctx {
   unsigned int total_customers;                             ///< number of customers served
   unsigned int total_burgers[BURGER_TYPE_MAX];              ///< number of burgers produced by types
   unsigned int total_queueing;                              ///< number of customers in queue
+  unsigned long latency[STATS_LATENCY_BUCKETS];             ///< served requests by latency bucket
+  unsigned int cancelled;                                   ///< requests cancelled on hangup
+  unsigned int saved_burgers;                               ///< burgers not cooked due to hangups
+  unsigned int wasted_burgers;                              ///< burgers cooked for departed ones
+  unsigned int deadline_met;                                ///< requests served by their deadline
+  unsigned int deadline_missed;                             ///< requests served after deadline
+  unsigned int rejected;                                    ///< requests with infeasible deadline
+  unsigned long handoffs;                                   ///< customers handed to serving pool
+  uint64_t handoff_wait_ns;                                 ///< total time customers waited
+  uint64_t handoff_wait_max_ns;                             ///< longest time a customer waited
+  unsigned long conn_closed;                                ///< connections closed
+  uint64_t conn_buf_total;                                  ///< line buffer bytes of all of them
+  size_t conn_buf_max;                                      ///< largest line buffer of one of them
   OrderList list;                                           ///< starting point of list structure
-  pthread_mutex_t lock;                                     ///< lock variable for server context
+  lockstat_mutex_t lock;                                    ///< lock variable for server context
+};
+
+/// @brief connected customer handed to a serving thread
+struct customer {
+  int fd;                                                   ///< client socket (TCP)
+  struct shm_endpoint *shm;                                 ///< shared-memory transport or NULL
+  struct timespec accepted;                                 ///< time the customer was accepted
+};
+
+/// @brief batch of orders of a streamed request
+struct stream_batch {
+  Node **orders;                                            ///< issued orders
+  unsigned int count;                                       ///< number of orders
+};
+
+/// @brief streamed request. Burgers are issued in batches of STREAM_BATCH while the request line is
+///        still arriving and at most STREAM_WINDOW batches are in the kitchen at a time, so the
+///        memory held for one request is bounded regardless of its length.
+struct stream {
+  struct customer *customer;                                ///< customer sending the request
+  unsigned int customerID;                                  ///< customer ID
+  struct stream_batch batch[STREAM_WINDOW];                 ///< batches in the kitchen (ring)
+  unsigned int head;                                        ///< index of the oldest batch
+  unsigned int inflight;                                    ///< number of batches in the kitchen
+  enum burger_type pending[STREAM_BATCH];                   ///< parsed burgers not yet issued
+  unsigned int npending;                                    ///< number of entries in @a pending
+  enum burger_type *types;                                  ///< tokenizer output
+  unsigned int capacity;                                    ///< number of entries in @a types
+  unsigned int burgers;                                     ///< burgers issued so far
+  char **buf;                                               ///< reply scratch buffer
+  size_t *buflen;                                           ///< size of @a buf
+  bool cancelled;                                           ///< customer has left
+};
+
+/// @brief bounded FIFO handing accepted customers to the serving-thread pool. Admission control
+///        keeps at most CUSTOMER_MAX customers in the server, so the queue never overflows.
+struct handoff_queue {
+  struct customer slot[CUSTOMER_MAX];                       ///< queued customers
+  unsigned int head;                                        ///< index of the oldest customer
+  unsigned int count;                                       ///< number of queued customers
+  lockstat_mutex_t lock;                                    ///< protects the queue
+  pthread_cond_t nonempty;                                  ///< signalled on enqueue
+};
+
+/// @brief server backend handling accept/recv/send
+enum server_backend {
+  BACKEND_THREAD,                                           ///< pool of blocking serving threads
+  BACKEND_URING,                                            ///< single io_uring event loop
 };
 
+/// @brief state of a client connection served by the io_uring backend
+enum uring_conn_state {
+  CONN_WELCOME,                                             ///< sending welcome message
+  CONN_REQUEST,                                             ///< receiving request line
+  CONN_COOKING,                                             ///< orders issued, waiting for kitchens
+  CONN_GOODBYE,                                             ///< sending order string
+  CONN_CANCELLED,                                           ///< hung up, started burgers cooking
+  CONN_CLOSED,                                              ///< closed, waiting for the hangup poll
+};
+
+/// @brief client connection served by the io_uring backend
+struct uring_conn {
+  int fd;                                                   ///< client socket
+  enum uring_conn_state state;                              ///< connection state
+  unsigned int customerID;                                  ///< customer ID
+  char *buffer;                                             ///< request buffer
+  size_t buflen;                                            ///< size of request buffer
+  size_t pos;                                               ///< number of bytes received
+  char *message;                                            ///< message being sent (in buffer)
+  size_t msglen;                                            ///< length of message
+  size_t sent;                                              ///< number of bytes of message sent
+  enum burger_type *types;                                  ///< parsed burger types
+  unsigned int burger_count;                                ///< number of burgers in request
+  Node **order_list;                                        ///< issued orders
+  struct timespec start;                                    ///< time the customer was accepted
+  bool polling;                                             ///< hangup poll is armed
+  bool rejected;                                            ///< deadline infeasible, not issued
+  struct uring_conn *next_done;                             ///< next completed connection
+  struct uring_conn *next_send;                             ///< next send deferred to batch end
+};
+
+/// @}
+
+/// @name Lock classes
+/// Mutexes are profiled per class when built with LOCKSTAT (see lockstat.h).
+/// @{
+
+LOCKSTAT_CLASS(server_ctx);                                 ///< server_ctx.lock
+LOCKSTAT_CLASS(request);                                    ///< `cond_mutex` of every request
+LOCKSTAT_CLASS(handoff);                                    ///< handoff.lock
+LOCKSTAT_CLASS(ring_done);                                  ///< ring_done_lock
+
 /// @}
 
 /// @name Global variables
 /// @{
 
-int listenfd;                                               ///< listen file descriptor
+int listenfd = -1;                                          ///< listen file descriptor
 struct mcdonalds_ctx server_ctx;                            ///< keeps server context
 sig_atomic_t keep_running = 1;                              ///< keeps all the threads running
+volatile sig_atomic_t interrupts;                           ///< number of SIGINTs received
 pthread_t kitchen_thread[NUM_KITCHEN];                      ///< thread for kitchen
-pthread_mutex_t kitchen_mutex;                              ///< shared mutex for kitchen threads
+unsigned int kitchen_count = NUM_KITCHEN;                   ///< number of kitchens
+bool kitchen_log = true;                                    ///< print every burger made
+uint64_t burger_cook_ns[BURGER_TYPE_MAX];                   ///< expected cook time by type (ns)
+enum server_backend backend = BACKEND_THREAD;               ///< selected server backend
+unsigned short port = PORT;                                 ///< listening port
+struct net_options net_opt = NET_OPTIONS_DEFAULT;           ///< listening socket tuning
+unsigned short status_port = 0;                             ///< load status port (0: disabled)
+int statusfd = -1;                                          ///< load status listen file descriptor
+pthread_t status_thread;                                    ///< thread answering status queries
+const char *shm_path = NULL;                                ///< Unix socket of the shm transport
+int shmfd = -1;                                             ///< shm transport listen socket
+pthread_t shm_thread;                                       ///< thread accepting shm clients
+unsigned int serve_pool_size = CUSTOMER_MAX;                ///< number of serving threads
+struct handoff_queue handoff = {                            ///< accepted customers to serve
+  .lock = LOCKSTAT_MUTEX_INITIALIZER(handoff), .nonempty = PTHREAD_COND_INITIALIZER
+};
+pthread_once_t serve_pool_once = PTHREAD_ONCE_INIT;        ///< starts the pool on first use
+struct uring server_ring;                                   ///< ring of the io_uring backend
+int ring_eventfd = -1;                                      ///< kitchen -> ring completion doorbell
+struct uring_conn *ring_done;                               ///< completed connections to reply to
+lockstat_mutex_t ring_done_lock =                           ///< protects ring_done
+  LOCKSTAT_MUTEX_INITIALIZER(ring_done);
+size_t ring_commit_lsn;                                     ///< journal records to commit per batch
+struct uring_conn *ring_sends;                              ///< sends deferred to batch end
+const char *journal_path = NULL;                            ///< order journal file (NULL: disabled)
+struct journal order_journal;                               ///< order journal
+struct journal *journal = NULL;                             ///< &order_journal if enabled
+const char *stats_path = NULL;                              ///< statistics file (NULL: disabled)
+struct stats_page *stats = NULL;                            ///< mapped statistics page
+struct kitchen pipeline;                                    ///< pipelined kitchen (0 stations: off)
+const char *trace_path = NULL;                              ///< arrival trace file (NULL: disabled)
+struct trace_writer arrival_trace;                          ///< arrival trace
+struct trace_writer *trace = NULL;                          ///< &arrival_trace if enabled
+#ifdef MCDONALDS_SIM
+uint64_t sim_clock = 0;                                     ///< virtual time of the simulation (ns)
+#endif
+
+/// @}
+
+
+/// @brief publish the counters of server_ctx in the statistics page. Must be called with
+///        server_ctx.lock held, which serializes the writers of the page's seqlock.
+static void publish_stats(void)
+{
+  struct stats_page s;
+  int i;
+
+  if (stats == NULL) return;
+
+  s.customers = server_ctx.total_customers;
+  for (i = 0; i < BURGER_TYPE_MAX; i++) s.burgers[i] = server_ctx.total_burgers[i];
+  s.queue = server_ctx.list.count;
+  s.inflight = server_ctx.total_queueing;
+  for (i = 0; i < STATS_LATENCY_BUCKETS; i++) s.latency[i] = server_ctx.latency[i];
+  s.cancelled = server_ctx.cancelled;
+  s.saved = server_ctx.saved_burgers;
+  s.wasted = server_ctx.wasted_burgers;
+
+  stats_publish(stats, &s);
+}
+
+/// @brief convert a timespec to nanoseconds
+static uint64_t timespec_ns(const struct timespec *ts)
+{
+  return (uint64_t)ts->tv_sec * 1000000000ULL + ts->tv_nsec;
+}
+
+/// @brief current time of CLOCK_MONOTONIC in nanoseconds (the virtual clock in simulation builds)
+static uint64_t now_ns(void)
+{
+#ifdef MCDONALDS_SIM
+  return sim_clock;
+#else
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return timespec_ns(&ts);
+#endif
+}
+
+/// @brief account a served request that started at @a start in the latency histogram
+/// @param start time the customer was accepted
+static void record_latency(const struct timespec *start)
+{
+  server_ctx.latency[stats_latency_bucket((now_ns() - timespec_ns(start)) * 1e-6)]++;
+}
+
+/// @name OrderList heap
+/// The OrderList is a binary min-heap ordered by (deadline, arrival). Every Node knows its heap
+/// position, so a cancelled order is removed in O(log n). Must be called with server_ctx.lock held.
+/// @{
+
+static bool order_before(const Node *a, const Node *b)
+{
+  return (a->deadline < b->deadline) || ((a->deadline == b->deadline) && (a->seq < b->seq));
+}
+
+static void heap_set(OrderList *l, unsigned int i, Node *n)
+{
+  l->heap[i] = n;
+  n->heap_index = i;
+}
+
+static void heap_sift_up(OrderList *l, unsigned int i)
+{
+  Node *n = l->heap[i];
+
+  while ((i > 0) && order_before(n, l->heap[(i - 1) / 2])) {
+    heap_set(l, i, l->heap[(i - 1) / 2]);
+    i = (i - 1) / 2;
+  }
+  heap_set(l, i, n);
+}
+
+static void heap_sift_down(OrderList *l, unsigned int i)
+{
+  Node *n = l->heap[i];
+  unsigned int child;
+
+  while ((child = 2 * i + 1) < l->count) {
+    if ((child + 1 < l->count) && order_before(l->heap[child + 1], l->heap[child])) child++;
+    if (!order_before(l->heap[child], n)) break;
+    heap_set(l, i, l->heap[child]);
+    i = child;
+  }
+  heap_set(l, i, n);
+}
+
+static void heap_push(OrderList *l, Node *n)
+{
+  if (l->count == l->capacity) {
+    l->capacity = l->capacity ? l->capacity * 2 : 64;
+    l->heap = (Node **)realloc(l->heap, sizeof(Node *) * l->capacity);
+  }
+  n->seq = l->seq++;
+  n->queued = true;
+  heap_set(l, l->count++, n);
+  heap_sift_up(l, l->count - 1);
+}
+
+static void heap_remove(OrderList *l, Node *n)
+{
+  unsigned int i = n->heap_index;
+  Node *last = l->heap[--l->count];
+
+  n->queued = false;
+  if (i == l->count) return;
+
+  heap_set(l, i, last);
+  if ((i > 0) && order_before(last, l->heap[(i - 1) / 2])) heap_sift_up(l, i);
+  else heap_sift_down(l, i);
+}
+
+/// @}
+
+/// @name Deadline index
+/// Queued orders with a deadline are also kept in a treap ordered like the heap. Every subtree
+/// knows the number and the cook time of its orders, so the work due no later than a deadline
+/// is summed in O(log n). Must be called with server_ctx.lock held.
+/// @{
+
+static void dl_update(Node *t)
+{
+  t->dl_count = 1;
+  t->dl_work = burger_cook_ns[t->type];
+  if (t->dl_left != NULL) {
+    t->dl_count += t->dl_left->dl_count;
+    t->dl_work += t->dl_left->dl_work;
+  }
+  if (t->dl_right != NULL) {
+    t->dl_count += t->dl_right->dl_count;
+    t->dl_work += t->dl_right->dl_work;
+  }
+}
+
+/// @brief split @a t into the orders before @a key (@a l) and the others (@a r)
+static void dl_split(Node *t, const Node *key, Node **l, Node **r)
+{
+  if (t == NULL) {
+    *l = *r = NULL;
+  } else if (order_before(t, key)) {
+    dl_split(t->dl_right, key, &t->dl_right, r);
+    dl_update(t);
+    *l = t;
+  } else {
+    dl_split(t->dl_left, key, l, &t->dl_left);
+    dl_update(t);
+    *r = t;
+  }
+}
+
+/// @brief join two treaps where all orders of @a a come before those of @a b
+static Node* dl_merge(Node *a, Node *b)
+{
+  if (a == NULL) return b;
+  if (b == NULL) return a;
+
+  if (a->dl_prio > b->dl_prio) {
+    a->dl_right = dl_merge(a->dl_right, b);
+    dl_update(a);
+    return a;
+  }
+  b->dl_left = dl_merge(a, b->dl_left);
+  dl_update(b);
+  return b;
+}
+
+static void dl_insert(OrderList *l, Node *n)
+{
+  Node *before, *after;
+
+  n->dl_left = n->dl_right = NULL;
+  n->dl_prio = (unsigned int)(n->seq * 2654435761u);
+  dl_update(n);
+
+  dl_split(l->deadlines, n, &before, &after);
+  l->deadlines = dl_merge(dl_merge(before, n), after);
+}
+
+/// @brief remove the first order of @a t, which is @a n
+static Node* dl_remove_first(Node *t, Node *n)
+{
+  if (t == n) return t->dl_right;
+
+  t->dl_left = dl_remove_first(t->dl_left, n);
+  dl_update(t);
+  return t;
+}
+
+static void dl_remove(OrderList *l, Node *n)
+{
+  Node *before, *after;
+
+  dl_split(l->deadlines, n, &before, &after);
+  l->deadlines = dl_merge(before, dl_remove_first(after, n));
+}
+
+/// @brief number (@a count) and cook time (@a work) of the indexed orders due by @a deadline
+static void dl_due(const OrderList *l, uint64_t deadline, unsigned int *count, uint64_t *work)
+{
+  const Node *t = l->deadlines;
+
+  *count = 0;
+  *work = 0;
+  while (t != NULL) {
+    if (t->deadline <= deadline) {
+      *count += t->dl_count - (t->dl_right != NULL ? t->dl_right->dl_count : 0);
+      *work += t->dl_work - (t->dl_right != NULL ? t->dl_right->dl_work : 0);
+      t = t->dl_right;
+    } else {
+      t = t->dl_left;
+    }
+  }
+}
+
+/// @brief queue an order in the OrderList (and in the deadline index if it has a deadline)
+static void order_push(OrderList *l, Node *n)
+{
+  heap_push(l, n);
+  if (n->has_deadline) dl_insert(l, n);
+}
+
+/// @brief remove a queued order from the OrderList
+static void order_remove(OrderList *l, Node *n)
+{
+  heap_remove(l, n);
+  if (n->has_deadline) dl_remove(l, n);
+}
+
+/// @}
+
+/// @brief Enqueue elements in the OrderList without journaling them
+/// @param customerID customer ID
+/// @param types list of burger types
+/// @param burger_count number of burgers
+/// @param deadline absolute deadline of the request (ns, CLOCK_MONOTONIC)
+/// @param has_deadline true if the customer requested @a deadline
+/// @param notify io_uring connection to notify when the request is done, NULL to signal `cond`
+/// @retval Node** of issued order Nodes
+static Node** queue_orders(unsigned int customerID, enum burger_type *types,
+                           unsigned int burger_count, uint64_t deadline, bool has_deadline,
+                           void *notify)
+{
+  // List of node pointers that are to be issued
+  Node **node_list = (Node **)malloc(sizeof(Node *) * burger_count);
+
+  // Initialize list of made burgers for request; filled back to front by make_burger()
+  enum burger_type *made = (enum burger_type *)malloc(sizeof(enum burger_type) * burger_count);
+
+  // Initialize conditon variable and mutex for request
+  pthread_cond_t *cond = (pthread_cond_t*)malloc(sizeof(pthread_cond_t));
+  lockstat_mutex_t *cond_mutex = (lockstat_mutex_t*)malloc(sizeof(lockstat_mutex_t));
+  pthread_cond_init(cond, NULL);
+  lockstat_init(cond_mutex, request);
+
+  // Initialize remaining count
+  unsigned int *remain_count = (unsigned int*)malloc(sizeof(unsigned int));
+  *remain_count = burger_count;
+
+  for (int i=0; i<burger_count; i++){
+    // Create new Node
+    Node *new_node = malloc(sizeof(Node));
+
+    // Initialize Node variables
+    new_node->customerID = customerID;
+    new_node->type = types[i];
+    new_node->deadline = deadline;
+    new_node->has_deadline = has_deadline;
+    new_node->remain_count = remain_count;
+    new_node->made = made;
+    new_node->cond = cond;
+    new_node->cond_mutex = cond_mutex;
+    new_node->notify = notify;
+
+    // Add new node to node list
+    node_list[i] = new_node;
+  }
+
+  // Add Nodes to the heap
+  lockstat_lock(&server_ctx.lock);
+  for (int i=0; i<burger_count; i++) order_push(&server_ctx.list, node_list[i]);
+  publish_stats();
+  lockstat_unlock(&server_ctx.lock);
+
+  // Return node list
+  return node_list;
+}
+
+/// @brief estimate whether a request of @a types arriving at @a now can be made by @a deadline.
+///        Under EDF only queued orders due no later than @a deadline are served before it. Their
+///        cook time and that of the request's own burgers is spread over the kitchens, plus one
+///        longest burger of the request for the last kitchen to finish (list scheduling bound).
+///        The pipelined kitchen is estimated from its stations instead (see kitchen_estimate()).
+///        Must be called with server_ctx.lock held.
+static bool deadline_feasible(uint64_t now, uint64_t deadline, const enum burger_type *types,
+                              unsigned int burger_count)
+{
+  unsigned int ahead, i;
+  uint64_t ahead_work, work = 0, longest = 0;
+
+  dl_due(&server_ctx.list, deadline, &ahead, &ahead_work);
+
+  if (pipeline.nstations > 0) {
+    return now + kitchen_estimate(&pipeline, ahead + burger_count) <= deadline;
+  }
+
+  for (i = 0; i < burger_count; i++) {
+    work += burger_cook_ns[types[i]];
+    if (burger_cook_ns[types[i]] > longest) longest = burger_cook_ns[types[i]];
+  }
+
+  return now + (ahead_work + work - longest) / kitchen_count + longest <= deadline;
+}
+
+/// @brief Journal a request and enqueue its orders in the OrderList. Serving threads wait until
+///        the request is durable (group commit with concurrent requests); the io_uring backend
+///        commits once per completion batch, before any reply of the batch is submitted.
+///        A request with a deadline is rejected up front if it cannot be made in time.
+/// @param customerID customer ID
+/// @param types list of burger types
+/// @param burger_count number of burgers
+/// @param deadline_ms latency budget of the request in ms (0: none)
+/// @param notify io_uring connection to notify when the request is done, NULL to signal `cond`
+/// @retval Node** of issued order Nodes
+/// @retval NULL if the deadline is infeasible
+Node** issue_orders(unsigned int customerID, enum burger_type *types, unsigned int burger_count,
+                    unsigned int deadline_ms, void *notify)
+{
+  uint64_t now = now_ns(), deadline;
+  bool feasible = true;
+  size_t lsn;
+
+  if (deadline_ms > 0) {
+    deadline = now + deadline_ms * 1000000ULL;
+
+    lockstat_lock(&server_ctx.lock);
+    feasible = deadline_feasible(now, deadline, types, burger_count);
+    if (!feasible) {
+      server_ctx.rejected++;
+      publish_stats();
+    }
+    lockstat_unlock(&server_ctx.lock);
+
+    if (!feasible) return NULL;
+  } else {
+    deadline = DEADLINE_NONE;
+  }
+
+  if (journal != NULL) {
+    lsn = journal_append(journal, JOURNAL_ORDER, customerID, types, burger_count);
+    if (notify == NULL) journal_commit(journal, lsn);
+    else ring_commit_lsn = lsn;
+  }
+
+  return queue_orders(customerID, types, burger_count, deadline, deadline_ms > 0, notify);
+}
+
+/// @brief account a completed request against its deadline
+/// @param first_order first Node of the request
+static void account_deadline(Node *first_order)
+{
+  if (!first_order->has_deadline) return;
+
+  lockstat_lock(&server_ctx.lock);
+  if (now_ns() <= first_order->deadline) server_ctx.deadline_met++;
+  else server_ctx.deadline_missed++;
+  lockstat_unlock(&server_ctx.lock);
+}
+
+/// @brief Dequeue the order with the earliest deadline from the OrderList
+/// @retval Node* Node from the top of the heap
+Node* get_order(void)
+{
+  Node *target_node;
+
+  if (server_ctx.list.count == 0) return NULL;
+
+  lockstat_lock(&server_ctx.lock);
+
+  // another kitchen may have emptied the list since the unlocked check above
+  if (server_ctx.list.count == 0) {
+    lockstat_unlock(&server_ctx.lock);
+    return NULL;
+  }
+
+  target_node = server_ctx.list.heap[0];
+  order_remove(&server_ctx.list, target_node);
+  publish_stats();
+
+  lockstat_unlock(&server_ctx.lock);
+
+  return target_node;
+}
+
+/// @brief Returns number of element left in OrderList
+/// @retval number of element(s) in OrderList
+unsigned int order_left(void)
+{
+  int ret;
+
+  lockstat_lock(&server_ctx.lock);
+  ret = server_ctx.list.count;
+  lockstat_unlock(&server_ctx.lock);
+
+  return ret;
+}
+
+/// @brief number of burgers of the request of @a order that are neither made nor cancelled.
+///        Kitchens reduce `remain_count` with the request's `cond_mutex` held, cancel_orders()
+///        without it, so it is always accessed atomically.
+static unsigned int order_remain(Node *order)
+{
+  return __atomic_load_n(order->remain_count, __ATOMIC_ACQUIRE);
+}
+
+/// @brief hand a completed request over to the io_uring event loop
+/// @param conn struct uring_conn of the request
+void uring_server_notify(void *conn)
+{
+  struct uring_conn *c = (struct uring_conn *)conn;
+
+  lockstat_lock(&ring_done_lock);
+  c->next_done = ring_done;
+  ring_done = c;
+  lockstat_unlock(&ring_done_lock);
+
+  eventfd_write(ring_eventfd, 1);
+}
+
+/// @brief Cancel the orders of a request whose customer has left. Orders still in the OrderList
+///        are removed from the heap; orders a kitchen has already started are left to finish.
+///        The request completes (`cond` is signalled or the ring notified) exactly once, either
+///        here if nothing is cooking anymore or by the kitchen that finishes the last burger.
+///        The request's `cond_mutex` is not taken, as a kitchen may hold it for a whole burger.
+///        The caller counts the cancelled request with count_cancelled().
+/// @param order_list Node list returned by issue_orders()
+/// @param burger_count number of Nodes in @a order_list
+/// @retval number of burgers still being cooked
+unsigned int cancel_orders(Node **order_list, unsigned int burger_count)
+{
+  Node *first_order = order_list[0], *n;
+  unsigned int removed = 0, remain;
+
+  lockstat_lock(&server_ctx.lock);
+  for (unsigned int i = 0; i < burger_count; i++) {
+    n = order_list[i];
+    if (!n->queued) continue;
+
+    order_remove(&server_ctx.list, n);
+    removed++;
+  }
+  server_ctx.saved_burgers += removed;
+  server_ctx.wasted_burgers += burger_count - removed;
+  publish_stats();
+  lockstat_unlock(&server_ctx.lock);
+
+  // removed orders will never reduce the remaining count, so take them off here. The caller is
+  // the waiting serving thread or the ring, so the request needs no wakeup for its own waiter.
+  if (removed == 0) return order_remain(first_order);
+  remain = __atomic_sub_fetch(first_order->remain_count, removed, __ATOMIC_ACQ_REL);
+  if ((remain == 0) && (first_order->notify != NULL)) uring_server_notify(first_order->notify);
+
+  return remain;
+}
+
+/// @brief count a request cancelled because its customer has left
+void count_cancelled(void)
+{
+  lockstat_lock(&server_ctx.lock);
+  server_ctx.cancelled++;
+  publish_stats();
+  lockstat_unlock(&server_ctx.lock);
+}
+
+/// @brief account the burgers of a request that were cooked for a customer who has left
+/// @param burgers number of burgers
+void waste_burgers(unsigned int burgers)
+{
+  lockstat_lock(&server_ctx.lock);
+  server_ctx.wasted_burgers += burgers;
+  publish_stats();
+  lockstat_unlock(&server_ctx.lock);
+}
+
+/// @brief reduce `remain_count` of the request of a made burger and complete the request once
+///        every burger is made. Must be called with the request's `cond_mutex` held.
+/// @param order Order Node whose burger has been made
+/// @retval true if this was the last burger of the request
+static bool order_done(Node *order)
+{
+  enum burger_type type = order->type;
+  unsigned int customerID = order->customerID, remain;
+  pthread_t tid = pthread_self();
+
+  remain = __atomic_sub_fetch(order->remain_count, 1, __ATOMIC_ACQ_REL);
+  if (journal != NULL) journal_append(journal, JOURNAL_BURGER, customerID, &type, 1);
+
+  if (kitchen_log) {
+    printf("[Thread %lu] %s burger for customer %u is ready\n", tid, burger_names[type],
+           customerID);
+  }
+
+  // If every burger is made, fire signal to serving thread (or post to the ring)
+  if(remain == 0){
+    if (kitchen_log) printf("[Thread %lu] all orders done for customer %u\n", tid, customerID);
+    if (order->notify != NULL) uring_server_notify(order->notify);
+    else pthread_cond_signal(order->cond);
+  }
+  return remain == 0;
+}
+
+/// @brief increase the number of made burgers of @a type
+static void count_burger(enum burger_type type)
+{
+  lockstat_lock(&server_ctx.lock);
+  server_ctx.total_burgers[type]++;
+  publish_stats();
+  lockstat_unlock(&server_ctx.lock);
+}
+
+/// @brief order source of the pipelined kitchen's first station
+static void* pipeline_source(void)
+{
+  return get_order();
+}
+
+/// @brief record the burger of an order whose cooking time has already been spent elsewhere and
+///        complete its request if it was the last one. The request mutex is held just for that.
+/// @param order Order Node
+/// @retval true if every burger of the request is made
+static bool complete_order(Node *order)
+{
+  enum burger_type type = order->type;
+  bool done;
+
+  lockstat_lock(order->cond_mutex);
+  order->made[order_remain(order) - 1] = type;
+  done = order_done(order);
+  lockstat_unlock(order->cond_mutex);
+
+  count_burger(type);
+  return done;
+}
+
+/// @brief "cook" burger. The cooking time is spent without any lock, so the burgers of one
+///        request are made in parallel; complete_order() then takes the request's `cond_mutex`
+///        just to record the burger in the made list and reduce `remain_count`. The order string
+///        is assembled from the interned burger names only when the reply is sent.
+/// @param order Order Node
+void make_burger(Node *order)
+{
+  // the cooking time is part of the exercise and is not to be optimized away
+  sleep(BURGER_COOK_SEC);
+
+  complete_order(order);
+}
+
+/// @brief complete an order that has passed all stations of the pipelined kitchen. The stations
+///        have spent the cooking time, so burgers of one request are made in parallel.
+/// @param item Order Node
+static void pipeline_finish(void *item)
+{
+  complete_order((Node *)item);
+}
+
+/// @brief Kitchen task for kitchen thread
+void* kitchen_task(void *dummy)
+{
+  Node *order;
+  enum burger_type type;
+  unsigned int customerID;
+  pthread_t tid = pthread_self();
+
+  printf("[Thread %lu] Kitchen thread ready\n", tid);
+
+  while (keep_running || order_left()) {
+    // Keep dequeuing if possible
+    order = get_order();
+
+    // If no order is available, sleep and try again
+    if (order == NULL) {
+      sleep(2);
+      continue;
+    }
+
+    type = order->type;
+    customerID = order->customerID;
+    printf("[Thread %lu] generating %s burger for customer %u\n", tid, burger_names[type],
+           customerID);
+
+    // Make burger and reduce `remain_count` of request
+    make_burger(order);
+  }
+
+  printf("[Thread %lu] terminated\n", tid);
+  pthread_exit(NULL);
+}
+
+/// @brief Split a request line into burger types and an optional trailing deadline "@<ms>"
+/// @param request request line
+/// @param len length of @a request
+/// @param burger_count number of parsed burgers. Out parameter.
+/// @param deadline_ms requested latency budget in ms (> 0), 0 if none. Out parameter.
+/// @retval enum burger_type* list of requested types (free with free())
+/// @retval NULL if the request is empty or contains an unknown burger or a malformed deadline
+///         (including "@0")
+enum burger_type* parse_request(const char *request, size_t len, unsigned int *burger_count,
+                                unsigned int *deadline_ms)
+{
+  enum burger_type *types = NULL;
+  unsigned int capacity = 0;
+  size_t end = len, tok;
+  int count;
+
+  // locate the last token of the line
+  while ((end > 0) && isspace((unsigned char)request[end - 1])) end--;
+  tok = end;
+  while ((tok > 0) && !isspace((unsigned char)request[tok - 1])) tok--;
+
+  *deadline_ms = 0;
+  if ((tok < end) && (request[tok] == '@')) {
+    if (tok + 1 == end) return NULL;
+    for (size_t i = tok + 1; i < end; i++) {
+      if (!isdigit((unsigned char)request[i]) || (*deadline_ms > UINT_MAX / 10 - 1)) return NULL;
+      *deadline_ms = *deadline_ms * 10 + (request[i] - '0');
+    }
+    // 0 means "no deadline" internally, so a zero budget is malformed rather than unlimited
+    if (*deadline_ms == 0) return NULL;
+    len = tok;
+  }
+
+  count = request_tokenize(request, len, &types, &capacity);
+  if (count <= 0) {
+    free(types);
+    return NULL;
+  }
+
+  *burger_count = count;
+  return types;
+}
+
+/// @brief Release the Nodes of a completed batch of orders without journaling the request as done
+/// @param order_list Node list returned by issue_orders()
+/// @param burger_count number of Nodes in @a order_list
+static void release_orders(Node **order_list, unsigned int burger_count)
+{
+  Node *first_order = order_list[0];
+
+  // wait until the kitchen that completed the request has released the request mutex
+  lockstat_lock(first_order->cond_mutex);
+  lockstat_unlock(first_order->cond_mutex);
+
+  pthread_cond_destroy(first_order->cond);
+  lockstat_destroy(first_order->cond_mutex);
+  free(first_order->cond);
+  free(first_order->cond_mutex);
+  free(first_order->made);
+  free(first_order->remain_count);
+
+  for (unsigned int i = 0; i < burger_count; i++) free(order_list[i]);
+  free(order_list);
+}
+
+/// @brief Release the Nodes of a completed request together with their shared variables
+/// @param order_list Node list returned by issue_orders()
+/// @param burger_count number of Nodes in @a order_list
+void free_orders(Node **order_list, unsigned int burger_count)
+{
+  // the customer has been served or has left; either way there is nothing to recover
+  if (journal != NULL) journal_append(journal, JOURNAL_DONE, order_list[0]->customerID, NULL, 0);
+
+  release_orders(order_list, burger_count);
+}
+
+/// @name Reply construction
+/// Replies are assembled from static fragments and the interned burger names into a per-connection
+/// scratch buffer, so the reply path neither allocates nor duplicates burger names.
+/// @{
+
+static const char welcome_prefix[] = "Welcome to McDonald's, customer #";
+static const char goodbye_prefix[] = "Your order(";
+static const char goodbye_suffix[] = ") is ready! Goodbye!\n";
+static const char reject_message[] = "Sorry, we cannot make your order in time. Goodbye!\n";
+static const char ready_prefix[] = "Ready: ";
+static const char ready_suffix[] = "\n";
+static const char stream_header[] = "stream";
+static const char stream_goodbye[] = "Your order(%u burgers) is ready! Goodbye!\n";
+static size_t burger_name_len[BURGER_TYPE_MAX];             ///< lengths of burger_names[]
+
+/// @brief format the welcome message for @a customerID into @a buf
+/// @param buf scratch buffer (at least BUF_INITIAL bytes)
+/// @param customerID customer ID
+/// @retval length of the message (excluding the terminating '\0')
+size_t format_welcome(char *buf, unsigned int customerID)
+{
+  char digits[10];
+  int n = 0;
+  char *p = buf;
+
+  memcpy(p, welcome_prefix, sizeof(welcome_prefix) - 1);
+  p += sizeof(welcome_prefix) - 1;
+
+  do {
+    digits[n++] = '0' + customerID % 10;
+    customerID /= 10;
+  } while (customerID > 0);
+  while (n > 0) *p++ = digits[--n];
+
+  *p++ = '\n';
+  *p = '\0';
+
+  return p - buf;
+}
+
+/// @brief format a reply listing the burgers in @a made between @a prefix and @a suffix into
+///        @a buf, which is grown with buf_grow() if the reply does not fit.
+/// @param buf scratch buffer. In/out parameter.
+/// @param buflen size of scratch buffer. In/out parameter.
+/// @param prefix text before the burgers
+/// @param prefix_len length of @a prefix
+/// @param suffix text after the burgers
+/// @param suffix_len length of @a suffix
+/// @param made burgers made by the kitchen, most recent first
+/// @param burger_count number of burgers in @a made
+/// @retval length of the message (excluding the terminating '\0')
+static size_t format_burgers(char **buf, size_t *buflen, const char *prefix, size_t prefix_len,
+                             const char *suffix, size_t suffix_len, enum burger_type *made,
+                             unsigned int burger_count)
+{
+  size_t len = prefix_len + suffix_len + 1;
+  unsigned int i;
+  char *p;
+
+  for (i = 0; i < burger_count; i++) len += burger_name_len[made[i]] + 1;
+  while (len > *buflen) *buf = buf_grow(*buf, buflen);
+
+  p = *buf;
+  memcpy(p, prefix, prefix_len);
+  p += prefix_len;
+
+  // list burgers in the order they were made
+  for (i = burger_count; i-- > 0; ) {
+    memcpy(p, burger_names[made[i]], burger_name_len[made[i]]);
+    p += burger_name_len[made[i]];
+    if (i > 0) *p++ = ' ';
+  }
+
+  memcpy(p, suffix, suffix_len);
+  p += suffix_len;
+  *p = '\0';
+
+  return p - *buf;
+}
+
+/// @brief format the goodbye message listing the burgers in @a made into @a buf. @a buf is grown
+///        with buf_grow() if the reply does not fit.
+/// @param buf scratch buffer. In/out parameter.
+/// @param buflen size of scratch buffer. In/out parameter.
+/// @param made burgers made by the kitchen, most recent first
+/// @param burger_count number of burgers in @a made
+/// @retval length of the message (excluding the terminating '\0')
+size_t format_goodbye(char **buf, size_t *buflen, enum burger_type *made,
+                      unsigned int burger_count)
+{
+  return format_burgers(buf, buflen, goodbye_prefix, sizeof(goodbye_prefix) - 1, goodbye_suffix,
+                        sizeof(goodbye_suffix) - 1, made, burger_count);
+}
+
+/// @}
+
+/// @brief read a line from a customer over TCP or the shared-memory transport (see get_line())
+static int customer_get_line(struct customer *c, char **buf, size_t *cur_len)
+{
+  if (c->shm != NULL) return shm_get_line(c->shm, buf, cur_len);
+  return get_line(c->fd, buf, cur_len);
+}
+
+/// @brief write a line to a customer over TCP or the shared-memory transport (see put_line())
+static int customer_put_line(struct customer *c, char *buf, size_t len)
+{
+  if (c->shm != NULL) return shm_put_line(c->shm, buf, len);
+  return put_line(c->fd, buf, len);
+}
+
+/// @brief check without blocking whether a customer has hung up (TCP or shared memory). The
+///        protocol has no half-close, so a customer that closed its sending side (POLLRDHUP, the
+///        only event a TCP close() raises) has left just like a reset connection.
+static bool customer_hung_up(struct customer *c)
+{
+  struct pollfd pfd = { c->shm != NULL ? c->shm->sock : c->fd, POLLRDHUP, 0 };
+
+  return (poll(&pfd, 1, 0) > 0) && (pfd.revents & (POLLRDHUP | POLLHUP | POLLERR));
+}
+
+/// @brief close the connection of a customer and release it
+static void close_customer(struct customer *c)
+{
+  if (c->shm != NULL) shm_close(c->shm);
+  else close(c->fd);
+}
+
+/// @brief account the line buffer of a connection that is being closed. Caller must hold
+///        server_ctx.lock.
+/// @param buflen final size of the connection's line buffer
+static void account_connection(size_t buflen)
+{
+  server_ctx.conn_closed++;
+  server_ctx.conn_buf_total += buflen;
+  if (buflen > server_ctx.conn_buf_max) server_ctx.conn_buf_max = buflen;
+}
+
+/// @brief error function for the serve_client
+/// @param clientfd file descriptor of the client*
+/// @param newsock struct customer of the client as void*
+/// @param newsock buffer for the messages*
+/// @param buflen size of @a buffer
+void error_client(int clientfd, void *newsock,char *buffer, size_t buflen) {
+  close_customer((struct customer *)newsock);
+  buf_free(buffer, buflen);
+
+  lockstat_lock(&server_ctx.lock);
+  server_ctx.total_queueing--;
+  account_connection(buflen);
+  publish_stats();
+  lockstat_unlock(&server_ctx.lock);
+}
+
+/// @brief wait until the kitchens are done with a list of orders, checking every HANGUP_CHECK_MS
+///        whether the customer is still there. If the customer leaves, the remaining orders are
+///        cancelled and @a cancelled is set; orders of a customer that has already left are
+///        cancelled right away.
+/// @param customer customer waiting for the orders
+/// @param order_list Node list returned by issue_orders()
+/// @param burger_count number of Nodes in @a order_list
+/// @param customerID customer ID
+/// @param cancelled true if the customer has left. In/out parameter.
+static void wait_orders(struct customer *customer, Node **order_list, unsigned int burger_count,
+                        unsigned int customerID, bool *cancelled)
+{
+  Node *first_order = order_list[0];
+  struct timespec timeout;        // end of the current completion wait
+  unsigned int cooking;           // burgers in the kitchen when the customer left
+
+  if (*cancelled) cancel_orders(order_list, burger_count);
+
+  // All orders share the same `remain_count`, so access it through the first order
+  lockstat_lock(first_order->cond_mutex);
+  while (order_remain(first_order) > 0) {
+    clock_gettime(CLOCK_REALTIME, &timeout);
+    timeout.tv_nsec += HANGUP_CHECK_MS * 1000000L;
+    timeout.tv_sec += timeout.tv_nsec / 1000000000L;
+    timeout.tv_nsec %= 1000000000L;
+    lockstat_cond_timedwait(first_order->cond, first_order->cond_mutex, &timeout);
+
+    if (!*cancelled && (order_remain(first_order) > 0) && customer_hung_up(customer)) {
+      lockstat_unlock(first_order->cond_mutex);
+      cooking = cancel_orders(order_list, burger_count);
+      count_cancelled();
+      printf("Customer #%d left, cancelled orders (%u burger(s) still cooking)\n", customerID,
+             cooking);
+      *cancelled = true;
+      lockstat_lock(first_order->cond_mutex);
+    }
+  }
+  lockstat_unlock(first_order->cond_mutex);
+
+  // the customer may have left after the last check, while the last burger was cooking
+  if (!*cancelled && customer_hung_up(customer)) {
+    printf("Customer #%d left before pickup\n", customerID);
+    waste_burgers(burger_count);
+    *cancelled = true;
+  }
+}
+
+/// @brief close the connection of a served customer and account its latency
+/// @param customer customer
+/// @param buffer message buffer of the customer
+/// @param buflen size of @a buffer
+/// @param start time the customer was accepted
+static void finish_client(struct customer *customer, char *buffer, size_t buflen,
+                          const struct timespec *start)
+{
+  close_customer(customer);
+  buf_free(buffer, buflen);
+
+  lockstat_lock(&server_ctx.lock);
+  server_ctx.total_queueing--;
+  account_connection(buflen);
+  record_latency(start);
+  publish_stats();
+  lockstat_unlock(&server_ctx.lock);
+}
+
+/// @name Streamed requests
+/// A customer that sends the line "stream" instead of a request streams its burgers on the next
+/// line. The burgers are issued in batches as the bytes arrive, every finished batch is handed out
+/// right away as a "Ready: <burgers>" line, and a final "Your order(<n> burgers) is ready!" line
+/// completes the request. Streams have no deadline and are not recorded in the arrival trace.
+/// @{
+
+/// @brief check whether @a line is the header of a streamed request
+static bool stream_requested(const char *line, size_t len)
+{
+  while ((len > 0) && isspace((unsigned char)line[len - 1])) len--;
+  return (len == sizeof(stream_header) - 1) && (memcmp(line, stream_header, len) == 0);
+}
+
+/// @brief check without blocking whether the oldest batch of @a s is done
+static bool stream_batch_ready(struct stream *s)
+{
+  Node *first_order = s->batch[s->head].orders[0];
+  bool ready;
+
+  // a busy mutex means a kitchen is recording a burger of the batch; look again later
+  if (lockstat_trylock(first_order->cond_mutex) != 0) return false;
+  ready = order_remain(first_order) == 0;
+  lockstat_unlock(first_order->cond_mutex);
+
+  return ready;
+}
+
+/// @brief wait for the oldest batch of @a s, hand its burgers to the customer and release it
+static void stream_reply(struct stream *s)
+{
+  struct stream_batch *b = &s->batch[s->head];
+  size_t len;
+
+  wait_orders(s->customer, b->orders, b->count, s->customerID, &s->cancelled);
+
+  if (!s->cancelled) {
+    len = format_burgers(s->buf, s->buflen, ready_prefix, sizeof(ready_prefix) - 1, ready_suffix,
+                         sizeof(ready_suffix) - 1, b->orders[0]->made, b->count);
+    if (customer_put_line(s->customer, *s->buf, len) <= 0) {
+      printf("Error: cannot send data to client\n");
+      waste_burgers(b->count);
+      s->cancelled = true;
+    }
+  }
+
+  release_orders(b->orders, b->count);
+  b->orders = NULL;
+  s->head = (s->head + 1) % STREAM_WINDOW;
+  s->inflight--;
+}
+
+/// @brief issue the pending burgers of @a s as a new batch. If STREAM_WINDOW batches are already
+///        in the kitchen, the oldest one is handed out first.
+static void stream_issue(struct stream *s)
+{
+  struct stream_batch *b;
+
+  if (s->npending == 0) return;
+  if (s->inflight == STREAM_WINDOW) stream_reply(s);
+
+  // handing out the oldest batch may have found the customer gone; do not cook for nobody
+  if (s->cancelled) {
+    s->npending = 0;
+    return;
+  }
+
+  b = &s->batch[(s->head + s->inflight) % STREAM_WINDOW];
+  b->orders = issue_orders(s->customerID, s->pending, s->npending, 0, NULL);
+  b->count = s->npending;
+  s->burgers += s->npending;
+  s->npending = 0;
+  s->inflight++;
+}
+
+/// @brief parse complete burger names of a streamed request and issue every full batch
+/// @param s stream
+/// @param data burger names separated by whitespace
+/// @param len length of @a data
+/// @retval true on success
+/// @retval false if @a data contains an unknown burger
+static bool stream_feed(struct stream *s, const char *data, size_t len)
+{
+  int count = request_tokenize(data, len, &s->types, &s->capacity);
+
+  if (count < 0) return false;
+
+  for (int i = 0; (i < count) && !s->cancelled; i++) {
+    s->pending[s->npending++] = s->types[i];
+    if (s->npending == STREAM_BATCH) stream_issue(s);
+  }
+
+  return true;
+}
+
+/// @brief read the burger line of a streamed request from a TCP customer in chunks of STREAM_CHUNK
+///        bytes, feeding complete burger names to stream_feed() and handing out finished batches
+///        while the customer is still sending.
+/// @param s stream
+/// @retval 1 the whole line was read
+/// @retval 0 the customer has left
+/// @retval -1 the request contains an unknown burger
+static int stream_read(struct stream *s)
+{
+  char chunk[STREAM_TOKEN_MAX + STREAM_CHUNK];
+  struct pollfd pfd = { s->customer->fd, POLLIN, 0 };
+  size_t carry = 0, end, tok;
+  ssize_t n;
+  int ready;
+  char *nl;
+
+  while (!s->cancelled) {
+    // hand out finished batches; wait for more bytes only as long as nothing else is done
+    while ((s->inflight > 0) && stream_batch_ready(s)) stream_reply(s);
+    if (s->inflight > 0) {
+      ready = poll(&pfd, 1, HANGUP_CHECK_MS);
+      if ((ready < 0) && (errno == EINTR)) continue;
+      if (ready < 0) return 0;
+      if (ready == 0) continue;
+    }
+
+    n = recv(s->customer->fd, chunk + carry, STREAM_CHUNK, 0);
+    if ((n < 0) && (errno == EINTR)) continue;
+    if (n <= 0) return 0;
+    end = carry + n;
+
+    nl = memchr(chunk + carry, '\n', n);
+    if (nl != NULL) return stream_feed(s, chunk, nl - chunk) ? 1 : -1;
+
+    // carry a burger name split across reads over to the next chunk
+    tok = end;
+    while ((tok > 0) && ((unsigned char)chunk[tok - 1] > ' ')) tok--;
+    if (end - tok >= STREAM_TOKEN_MAX) return -1;
+    if (!stream_feed(s, chunk, tok)) return -1;
+
+    carry = end - tok;
+    memmove(chunk, chunk + tok, carry);
+  }
+
+  return 0;
+}
+
+/// @brief serve a streamed request after its header line has been received
+/// @param customer customer
+/// @param customerID customer ID
+/// @param buf message buffer. In/out parameter.
+/// @param buflen size of @a buf. In/out parameter.
+/// @retval true if the customer has been served
+/// @retval false if the request was invalid or the customer has left
+static bool serve_stream(struct customer *customer, unsigned int customerID, char **buf,
+                         size_t *buflen)
+{
+  struct stream s = { .customer = customer, .customerID = customerID, .buf = buf,
+                      .buflen = buflen };
+  int res, len;
+
+  printf("Customer #%d streams an order\n", customerID);
+
+  if (customer->shm != NULL) {
+    // the shared-memory transport delivers whole lines; the line is still issued in batches
+    len = customer_get_line(customer, buf, buflen);
+    res = (len <= 0) ? 0 : (stream_feed(&s, *buf, len) ? 1 : -1);
+  } else {
+    res = stream_read(&s);
+  }
+  if ((res > 0) && (s.burgers + s.npending == 0)) res = -1;
+
+  if (res < 0) {
+    printf("Error: invalid request from customer #%d\n", customerID);
+    s.cancelled = true;
+  } else if ((res == 0) && !s.cancelled) {
+    printf("Customer #%d left while streaming, cancelled orders\n", customerID);
+    count_cancelled();
+    s.cancelled = true;
+  }
+
+  if (!s.cancelled) stream_issue(&s);
+  while (s.inflight > 0) stream_reply(&s);
+  free(s.types);
+
+  // the request is journaled batch by batch; close it once every batch is released
+  if ((journal != NULL) && (s.burgers > 0)) {
+    journal_append(journal, JOURNAL_DONE, customerID, NULL, 0);
+  }
+  if (s.cancelled) return false;
+
+  len = snprintf(*buf, *buflen, stream_goodbye, s.burgers);
+  if (customer_put_line(customer, *buf, len) <= 0) {
+    printf("Error: cannot send data to client\n");
+    return false;
+  }
+
+  return true;
+}
+
+/// @}
+
+/// @brief serve one customer on a thread of the serving pool
+/// @param newsock struct customer of the client as void*
+void* serve_client(void *newsock)
+{
+  struct customer *customer = (struct customer *)newsock;
+  ssize_t read, sent;             // size of read and sent message
+  size_t msglen;                  // message buffer size
+  char *buffer;                   // message buffer
+  unsigned int customerID;        // customer ID
+  enum burger_type *types;        // list of burger types
+  Node **order_list = NULL;       // list of orders issued
+  int ret, clientfd;              // misc. values
+  unsigned int burger_count = 0;  // number of burgers in request
+  unsigned int deadline_ms;       // requested latency budget (0: none)
+  Node *first_order;              // first order of requests
+  struct timespec start;          // time the customer was accepted
+  bool cancelled = false;         // customer hung up while waiting
+
+  start = customer->accepted;
+  clientfd = customer->fd;
+  msglen = BUF_INITIAL;
+  buffer = buf_alloc(&msglen);
+
+  // Get customer ID
+  lockstat_lock(&server_ctx.lock);
+  customerID = server_ctx.total_customers++;
+  publish_stats();
+  lockstat_unlock(&server_ctx.lock);
+
+  printf("Customer #%d visited\n", customerID);
+
+  // Generate welcome message
+  ret = format_welcome(buffer, customerID);
+
+  // Send welcome to mcdonalds
+  sent = customer_put_line(customer, buffer, ret);
+  if (sent < 0) {
+    printf("Error: cannot send data to client\n");
+    error_client(clientfd, newsock, buffer, msglen);
+    return NULL;
+  }
+
+  // Receive request from the customer
+  read = customer_get_line(customer, &buffer, &msglen);
+  if (read <= 0) {
+    printf("Error: cannot read data from client\n");
+    error_client(clientfd, newsock, buffer, msglen);
+    return NULL;
+  }
+
+  // Streamed requests are issued and handed out batch by batch
+  if (stream_requested(buffer, read)) {
+    if (!serve_stream(customer, customerID, &buffer, &msglen)) {
+      error_client(clientfd, newsock, buffer, msglen);
+      return NULL;
+    }
+    finish_client(customer, buffer, msglen, &start);
+    return NULL;
+  }
+
+  // Parse and split request from the customer into orders
+  types = parse_request(buffer, read, &burger_count, &deadline_ms);
+  if (types == NULL) {
+    printf("Error: invalid request from customer #%d\n", customerID);
+    error_client(clientfd, newsock, buffer, msglen);
+    return NULL;
+  }
+  if (trace != NULL) trace_append(trace, timespec_ns(&start), types, burger_count, deadline_ms);
+
+  // Issue orders to kitchen and wait
+  order_list = issue_orders(customerID, types, burger_count, deadline_ms, NULL);
+  if (order_list == NULL) {
+    printf("Customer #%d rejected, deadline of %u ms cannot be met\n", customerID, deadline_ms);
+    customer_put_line(customer, (char *)reject_message, sizeof(reject_message) - 1);
+    free(types);
+    error_client(clientfd, newsock, buffer, msglen);
+    return NULL;
+  }
+  first_order = order_list[0];
+
+  wait_orders(customer, order_list, burger_count, customerID, &cancelled);
+
+  if (cancelled) {
+    free_orders(order_list, burger_count);
+    free(types);
+    error_client(clientfd, newsock, buffer, msglen);
+    return NULL;
+  }
+
+  // If request is successfully handled, hand ordered burgers and say goodbye
+  // All orders share the same `remain_count`, so access it through the first order
+  if (order_remain(first_order) == 0) {
+    ret = format_goodbye(&buffer, &msglen, first_order->made, burger_count);
+    sent = customer_put_line(customer, buffer, ret);
+    if (sent <= 0) {
+      printf("Error: cannot send data to client\n");
+      waste_burgers(burger_count);
+      free_orders(order_list, burger_count);
+      free(types);
+      error_client(clientfd, newsock, buffer, msglen);
+      return NULL;
+    }
+    account_deadline(first_order);
+  }
+
+  // If any, free unused variables
+  free_orders(order_list, burger_count);
+  free(types);
+
+  finish_client(customer, buffer, msglen, &start);
+
+  return NULL;
+}
+
+/// @name Serving-thread pool
+/// Accepted customers are queued in `handoff` and served by a fixed pool of serving threads with
+/// small stacks that is spawned once, so no thread is created or destroyed per customer.
+/// @{
+
+/// @brief serving thread: take customers from the handoff queue and serve them
+/// @param dummy unused
+static void* serve_task(void *dummy)
+{
+  struct customer customer;
+  struct timespec now;
+  uint64_t wait;
+
+  while (1) {
+    lockstat_lock(&handoff.lock);
+    while (handoff.count == 0) lockstat_cond_wait(&handoff.nonempty, &handoff.lock);
+    customer = handoff.slot[handoff.head];
+    handoff.head = (handoff.head + 1) % CUSTOMER_MAX;
+    handoff.count--;
+    lockstat_unlock(&handoff.lock);
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    wait = (uint64_t)(now.tv_sec - customer.accepted.tv_sec) * 1000000000ULL
+           + now.tv_nsec - customer.accepted.tv_nsec;
+
+    lockstat_lock(&server_ctx.lock);
+    server_ctx.handoffs++;
+    server_ctx.handoff_wait_ns += wait;
+    if (wait > server_ctx.handoff_wait_max_ns) server_ctx.handoff_wait_max_ns = wait;
+    lockstat_unlock(&server_ctx.lock);
+
+    serve_client(&customer);
+  }
 
-/// @}
+  return NULL;
+}
 
+/// @brief spawn the serving threads. Run once through serve_pool_once by the first frontend
+///        (TCP or shm) before it accepts customers.
+static void start_serve_pool(void)
+{
+  pthread_attr_t attr;
+  pthread_t tid;
+  unsigned int i;
+
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, SERVE_STACK_SIZE);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+  for (i = 0; i < serve_pool_size; i++) {
+    if (pthread_create(&tid, &attr, serve_task, NULL) != 0) {
+      perror("pthread_create");
+      break;
+    }
+  }
+  serve_pool_size = i;
 
-/// @brief Enqueue elements in tail of the OrderList
-/// @param customerID customer ID
-/// @param types list of burger types
-/// @param burger_count number of burgers
-/// @retval Node** of issued order Nodes
-Node** issue_orders(unsigned int customerID, enum burger_type *types, unsigned int burger_count)
+  pthread_attr_destroy(&attr);
+}
+
+/// @brief admit a customer and hand it to the serving pool
+/// @param fd client socket or -1
+/// @param shm shared-memory endpoint or NULL
+/// @param accepted time the customer was accepted
+/// @retval true if the customer was admitted; otherwise the connection has been closed
+static bool admit_customer(int fd, struct shm_endpoint *shm, const struct timespec *accepted)
 {
-  // List of node pointers that are to be issued
-  Node **node_list = (Node **)malloc(sizeof(Node *) * burger_count);
+  struct customer *c;
+
+  lockstat_lock(&server_ctx.lock);
+  if (server_ctx.total_queueing >= CUSTOMER_MAX) {
+    lockstat_unlock(&server_ctx.lock);
+    if (shm != NULL) shm_close(shm);
+    else close(fd);
+    return false;
+  }
+  server_ctx.total_queueing++;
+  publish_stats();
+  lockstat_unlock(&server_ctx.lock);
+
+  lockstat_lock(&handoff.lock);
+  c = &handoff.slot[(handoff.head + handoff.count) % CUSTOMER_MAX];
+  c->fd = fd;
+  c->shm = shm;
+  c->accepted = *accepted;
+  handoff.count++;
+  pthread_cond_signal(&handoff.nonempty);
+  lockstat_unlock(&handoff.lock);
+
+  return true;
+}
 
-  // Initialize order string for request
-  char **order_str = (char **)malloc(sizeof(char *));
-  *order_str = NULL;
+/// @}
 
-  // Initialize conditon variable and mutex for request
-  pthread_cond_t *cond = (pthread_cond_t*)malloc(sizeof(pthread_cond_t));
-  pthread_mutex_t *cond_mutex = (pthread_mutex_t*)malloc(sizeof(pthread_mutex_t));
-  pthread_cond_init(cond, NULL);
-  pthread_mutex_init(cond_mutex, NULL);
+/// @brief start server listening
+void start_server()
+{
+  int clientfd;
+  socklen_t addrlen;
+  struct sockaddr_storage client;
+  struct timespec accepted;
+
+  listenfd = open_listenfd_opt(port, &net_opt);
+  if (listenfd < 0) {
+    printf("Error: cannot bind to port %d\n", port);
+    return;
+  }
 
-  // Initialize remaining count
-  unsigned int *remain_count = (unsigned int*)malloc(sizeof(unsigned int));
-  *remain_count = burger_count;
+  pthread_once(&serve_pool_once, start_serve_pool);
+  printf("Listening...\n");
 
-  //
-  // TODO: Initialize shared Node variables if added any
-  //
+  // Keep listening and accepting clients
+  // Check if max number of customers is not exceeded after accepting
+  // Hand the client to the serving-thread pool
+  while (keep_running) {
+    addrlen = sizeof(client);
+    // serving threads use blocking I/O, so only CLOEXEC is requested here
+    clientfd = accept4(listenfd, (struct sockaddr *)&client, &addrlen, SOCK_CLOEXEC);
+    if (clientfd < 0) {
+      if (errno == EINTR) continue;
+      // sigint_handler() shuts the listening socket down
+      if (keep_running) perror("accept");
+      break;
+    }
 
-  for (int i=0; i<burger_count; i++){
-    // Create new Node
-    Node *new_node = malloc(sizeof(Node));
+    clock_gettime(CLOCK_MONOTONIC, &accepted);
+    admit_customer(clientfd, NULL, &accepted);
+  }
+}
 
-    // Initialize Node variables
-    new_node->customerID = customerID;
-    new_node->type = types[i];
-    new_node->next = NULL;
-    new_node->remain_count = remain_count;
-    new_node->order_str = order_str;
-    new_node->cond = cond;
-    new_node->cond_mutex = cond_mutex;
+/// @name io_uring backend
+/// @{
 
-    //
-    // TODO: Initialize other Node variables if added any
-    //
+#define RING_ENTRIES  256                                   ///< number of SQ entries
+#define RING_ACCEPT   1                                     ///< user_data of the multishot accept
+#define RING_EVENTFD  2                                     ///< user_data of the doorbell read
+#define RING_UNPOLL   3                                     ///< user_data of hangup poll removals
+#define RING_HANGUP   1                                     ///< tag bit: hangup poll of connection
 
-    // Add Node to list
-    pthread_mutex_lock(&server_ctx.lock);
-    if (server_ctx.list.tail == NULL) {
-      server_ctx.list.head = new_node;
-      server_ctx.list.tail = new_node;
-    } else {
-      server_ctx.list.tail->next = new_node;
-      server_ctx.list.tail = new_node;
-    }
-    server_ctx.list.count++;
-    pthread_mutex_unlock(&server_ctx.lock);
+/// @brief get a free SQE, flushing the submission queue if it is full
+static struct io_uring_sqe *ring_sqe(void)
+{
+  struct io_uring_sqe *sqe;
 
-    // Add new node to node list
-    node_list[i] = new_node;
+  while ((sqe = uring_get_sqe(&server_ring)) == NULL) {
+    uring_submit_and_wait(&server_ring, 0);
   }
+  return sqe;
+}
 
-  // Return node list
-  return node_list;
+/// @brief send the remaining part of the connection's message. The send is deferred until
+///        ring_flush_sends() at the end of the batch, so that no reply reaches the kernel
+///        (through ring_sqe() flushing a full SQ) before the batch's journal commit.
+static void ring_send(struct uring_conn *c)
+{
+  c->next_send = ring_sends;
+  ring_sends = c;
 }
 
-/// @brief Dequeue element from the OrderList
-/// @retval Node* Node from head of the list
-Node* get_order(void)
+/// @brief queue the sends deferred during a batch
+static void ring_flush_sends(void)
 {
-  Node *target_node;
+  struct uring_conn *c, *next;
 
-  if (server_ctx.list.head == NULL) return NULL;
+  for (c = ring_sends, ring_sends = NULL; c != NULL; c = next) {
+    next = c->next_send;
+    uring_prep_send(ring_sqe(), c->fd, c->message + c->sent, c->msglen - c->sent,
+                    (uint64_t)(uintptr_t)c);
+  }
+}
 
-  pthread_mutex_lock(&server_ctx.lock);
+/// @brief queue a receive into the free part of the connection's request buffer
+static void ring_recv(struct uring_conn *c)
+{
+  uring_prep_recv(ring_sqe(), c->fd, c->buffer + c->pos, c->buflen - c->pos - 1,
+                  (uint64_t)(uintptr_t)c);
+}
 
-  target_node = server_ctx.list.head;
+/// @brief close a connection of the io_uring backend and release its resources
+static void ring_close(struct uring_conn *c)
+{
+  int served = (c->state == CONN_GOODBYE) && !c->rejected && (c->sent == c->msglen);
 
-  if (server_ctx.list.head == server_ctx.list.tail) {
-    server_ctx.list.head = NULL;
-    server_ctx.list.tail = NULL;
+  lockstat_lock(&server_ctx.lock);
+  server_ctx.total_queueing--;
+  account_connection(c->buflen);
+  if (served) record_latency(&c->start);
+  publish_stats();
+  lockstat_unlock(&server_ctx.lock);
+
+  close(c->fd);
+  if (c->order_list != NULL) free_orders(c->order_list, c->burger_count);
+  free(c->types);
+  buf_free(c->buffer, c->buflen);
+
+  // the armed hangup poll still refers to `c`; it is released when the poll completes
+  if (c->polling) {
+    uring_prep_poll_remove(ring_sqe(), (uint64_t)(uintptr_t)c | RING_HANGUP, RING_UNPOLL);
+    c->state = CONN_CLOSED;
   } else {
-    server_ctx.list.head = server_ctx.list.head->next;
+    free(c);
   }
+}
 
-  server_ctx.list.count--;
+/// @brief handle a new connection from the multishot accept
+static void ring_accept(int clientfd)
+{
+  struct uring_conn *c;
 
-  pthread_mutex_unlock(&server_ctx.lock);
+  lockstat_lock(&server_ctx.lock);
+  if (server_ctx.total_queueing >= CUSTOMER_MAX) {
+    lockstat_unlock(&server_ctx.lock);
+    close(clientfd);
+    return;
+  }
+  server_ctx.total_queueing++;
+  publish_stats();
+  lockstat_unlock(&server_ctx.lock);
 
-  return target_node;
-}
+  c = (struct uring_conn *)calloc(1, sizeof(struct uring_conn));
+  clock_gettime(CLOCK_MONOTONIC, &c->start);
+  c->fd = clientfd;
+  c->buflen = BUF_INITIAL;
+  c->buffer = buf_alloc(&c->buflen);
 
-/// @brief Returns number of element left in OrderList
-/// @retval number of element(s) in OrderList
-unsigned int order_left(void)
-{
-  int ret;
+  // Get customer ID
+  lockstat_lock(&server_ctx.lock);
+  c->customerID = server_ctx.total_customers++;
+  publish_stats();
+  lockstat_unlock(&server_ctx.lock);
 
-  pthread_mutex_lock(&server_ctx.lock);
-  ret = server_ctx.list.count;
-  pthread_mutex_unlock(&server_ctx.lock);
+  printf("Customer #%d visited\n", c->customerID);
 
-  return ret;
+  // Generate welcome message
+  c->message = c->buffer;
+  c->msglen = format_welcome(c->buffer, c->customerID);
+  c->state = CONN_WELCOME;
+  ring_send(c);
 }
 
-/// @brief "cook" burger by appending burger name to order_str of Node
-/// @param order Order Node
-void make_burger(Node *order)
+/// @brief handle the completion of the pending operation of a connection
+static void ring_complete(struct uring_conn *c, int res)
 {
-  // == DO NOT MODIFY ==
-  enum burger_type type = order->type;
-  char *temp;
-
-  if(*(order->order_str) != NULL){
-    // If string is initialized, append burger name to order_string
+  unsigned int deadline_ms;
+
+  switch (c->state) {
+    case CONN_WELCOME:
+    case CONN_GOODBYE:
+      if (res <= 0) {
+        printf("Error: cannot send data to client\n");
+        if ((c->state == CONN_GOODBYE) && !c->rejected) waste_burgers(c->burger_count);
+        ring_close(c);
+        return;
+      }
+      c->sent += res;
+      if (c->sent < c->msglen) {
+        ring_send(c);
+      } else if (c->state == CONN_GOODBYE) {
+        ring_close(c);
+      } else {
+        c->state = CONN_REQUEST;
+        ring_recv(c);
+      }
+      break;
+
+    case CONN_REQUEST:
+      if (res <= 0) {
+        printf("Error: cannot read data from client\n");
+        ring_close(c);
+        return;
+      }
+      c->pos += res;
+      c->buffer[c->pos] = '\0';
+
+      // keep receiving until the whole request line has arrived
+      if (memchr(c->buffer + c->pos - res, '\n', res) == NULL) {
+        if (c->pos == c->buflen - 1) c->buffer = buf_grow(c->buffer, &c->buflen);
+        ring_recv(c);
+        return;
+      }
+
+      c->types = parse_request(c->buffer, c->pos, &c->burger_count, &deadline_ms);
+      if (c->types == NULL) {
+        printf("Error: invalid request from customer #%d\n", c->customerID);
+        ring_close(c);
+        return;
+      }
+      if (trace != NULL) {
+        trace_append(trace, timespec_ns(&c->start), c->types, c->burger_count, deadline_ms);
+      }
+
+      // the kitchen that completes the request posts `c` to the ring through uring_server_notify()
+      c->state = CONN_COOKING;
+      c->order_list = issue_orders(c->customerID, c->types, c->burger_count, deadline_ms, c);
+      if (c->order_list == NULL) {
+        printf("Customer #%d rejected, deadline of %u ms cannot be met\n", c->customerID,
+               deadline_ms);
+        memcpy(c->buffer, reject_message, sizeof(reject_message) - 1);
+        c->message = c->buffer;
+        c->msglen = sizeof(reject_message) - 1;
+        c->sent = 0;
+        c->rejected = true;
+        c->state = CONN_GOODBYE;
+        ring_send(c);
+        return;
+      }
+
+      // watch for the customer leaving while the orders are cooking (see customer_hung_up())
+      uring_prep_poll_add(ring_sqe(), c->fd, POLLRDHUP | POLLHUP | POLLERR,
+                          (uint64_t)(uintptr_t)c | RING_HANGUP);
+      c->polling = true;
+      break;
+
+    case CONN_COOKING:
+    case CONN_CANCELLED:
+    case CONN_CLOSED:
+      break;
+  }
+}
 
-    // Copy original string to temp buffer
-    int ret = asprintf(&temp, "%s", *(order->order_str));
-    if(ret < 0) perror("asprintf");
-    free(*(order->order_str));
+/// @brief handle the completion of the hangup poll of a connection
+static void ring_hangup(struct uring_conn *c, int res)
+{
+  unsigned int cooking;
 
-    // Append burger name to order_str
-    ret = asprintf(order->order_str, "%s %s", temp, burger_names[type]);
-    if(ret < 0) perror("asprintf");
-    free(temp);
-  }
-  else{
-    // If string is not initialized, copy burger name to order string
-    int str_len = strlen(burger_names[type]);
-    *(order->order_str) = (char *)malloc(sizeof(char) * str_len);
-    strncpy(*(order->order_str), burger_names[type], str_len);
+  c->polling = false;
+  if (c->state == CONN_CLOSED) {
+    free(c);
+    return;
   }
 
-  sleep(1);
-  // ===================
+  // poll removed, or the customer left after the kitchens were done
+  if ((res <= 0) || (c->state != CONN_COOKING)) return;
+
+  // the connection is closed once the request completes (see ring_reply_done())
+  c->state = CONN_CANCELLED;
+  cooking = cancel_orders(c->order_list, c->burger_count);
+  count_cancelled();
+  printf("Customer #%d left, cancelled orders (%u burger(s) still cooking)\n", c->customerID,
+         cooking);
 }
 
-/// @brief Kitchen task for kitchen thread
-void* kitchen_task(void *dummy)
+/// @brief reply to all connections whose orders have been completed by the kitchens
+static void ring_reply_done(void)
 {
-  Node *order;
-  enum burger_type type;
-  unsigned int customerID;
-  pthread_t tid = pthread_self();
+  struct uring_conn *c, *next;
 
-  printf("[Thread %lu] Kitchen thread ready\n", tid);
+  lockstat_lock(&ring_done_lock);
+  c = ring_done;
+  ring_done = NULL;
+  lockstat_unlock(&ring_done_lock);
 
-  while (keep_running || order_left()) {
-    // Keep dequeuing if possible
-    order = get_order();
+  for (; c != NULL; c = next) {
+    next = c->next_done;
 
-    // If no order is available, sleep and try again
-    if (order == NULL) {
-      sleep(2);
+    if (c->state == CONN_CANCELLED) {
+      ring_close(c);
       continue;
     }
 
-    type = order->type;
-    customerID = order->customerID;
-    printf("[Thread %lu] generating %s burger for customer %u\n", tid, burger_names[type], customerID);
+    c->msglen = format_goodbye(&c->buffer, &c->buflen, c->order_list[0]->made, c->burger_count);
+    c->message = c->buffer;
+    account_deadline(c->order_list[0]);
+    free_orders(c->order_list, c->burger_count);
+    c->order_list = NULL;
 
-    // Make burger and reduce `remain_count` of request
-    // - Use make_burger()
-    // - Reduce `remain_count` by one
-    // TODO
+    c->sent = 0;
+    c->state = CONN_GOODBYE;
+    ring_send(c);
+  }
+}
+
+/// @brief start server listening and serve all clients from a single io_uring event loop.
+///        Accepts are multishot, all SQEs prepared while reaping a batch of completions are
+///        submitted with one io_uring_enter(), and kitchens post completions through an eventfd
+///        that is read by the same ring.
+void start_server_uring(void)
+{
+  struct io_uring_sqe *sqe;
+  struct io_uring_cqe *cqe;
+  uint64_t user_data, doorbell;
+  int res;
+  unsigned int flags, dropped = 0;
+
+  if (uring_init(&server_ring, RING_ENTRIES) < 0) {
+    perror("io_uring_setup");
+    printf("io_uring is not available, falling back to thread backend\n");
+    start_server();
+    return;
+  }
+
+  ring_eventfd = eventfd(0, EFD_CLOEXEC);
+  if (ring_eventfd < 0) {
+    perror("eventfd");
+    uring_exit(&server_ring);
+    return;
+  }
+
+  listenfd = open_listenfd_opt(port, &net_opt);
+  if (listenfd < 0) {
+    printf("Error: cannot bind to port %d\n", port);
+    uring_exit(&server_ring);
+    return;
+  }
+
+  printf("Listening... (io_uring)\n");
 
-    printf("[Thread %lu] %s burger for customer %u is ready\n", tid, burger_names[type], customerID);
+  sqe = ring_sqe();
+  uring_prep_accept_multishot(sqe, listenfd, SOCK_NONBLOCK | SOCK_CLOEXEC, RING_ACCEPT);
+  sqe = ring_sqe();
+  uring_prep_read(sqe, ring_eventfd, &doorbell, sizeof(doorbell), RING_EVENTFD);
+
+  while (keep_running) {
+    if (uring_submit_and_wait(&server_ring, 1) < 0) {
+      perror("io_uring_enter");
+      break;
+    }
 
-    // If every burger is made, fire signal to serving thread
-    if(*(order->remain_count) == 0){
-      printf("[Thread %lu] all orders done for customer %u\n", tid, customerID);
-      pthread_cond_signal(order->cond);
+    // reap the whole batch of completions, including those the kernel held back because the CQ
+    // was full; new SQEs are submitted with the next enter
+    do {
+      while ((cqe = uring_peek_cqe(&server_ring)) != NULL) {
+        user_data = cqe->user_data;
+        res = cqe->res;
+        flags = cqe->flags;
+        uring_cqe_seen(&server_ring);
+
+        if (user_data == RING_ACCEPT) {
+          if (res >= 0) ring_accept(res);
+          else if ((res != -EINTR) && keep_running) printf("accept: %s\n", strerror(-res));
+          if (!(flags & IORING_CQE_F_MORE)) {
+            uring_prep_accept_multishot(ring_sqe(), listenfd, SOCK_NONBLOCK | SOCK_CLOEXEC,
+                                        RING_ACCEPT);
+          }
+        } else if (user_data == RING_EVENTFD) {
+          ring_reply_done();
+          uring_prep_read(ring_sqe(), ring_eventfd, &doorbell, sizeof(doorbell), RING_EVENTFD);
+        } else if (user_data == RING_UNPOLL) {
+          continue;
+        } else if (user_data & RING_HANGUP) {
+          ring_hangup((struct uring_conn *)(uintptr_t)(user_data & ~(uint64_t)RING_HANGUP), res);
+        } else {
+          ring_complete((struct uring_conn *)(uintptr_t)user_data, res);
+        }
+      }
+    } while (uring_cq_flush(&server_ring));
+    if (uring_cq_dropped(&server_ring) != dropped) {
+      dropped = uring_cq_dropped(&server_ring);
+      printf("Error: io_uring dropped %u completion(s)\n", dropped);
     }
 
-    // Increase burger count
-    pthread_mutex_lock(&server_ctx.lock);
-    server_ctx.total_burgers[type]++;
-    pthread_mutex_unlock(&server_ctx.lock);
+    // group commit of the requests issued in this batch, then release the batch's replies
+    if (ring_commit_lsn > 0) {
+      journal_commit(journal, ring_commit_lsn);
+      ring_commit_lsn = 0;
+    }
+    ring_flush_sends();
   }
 
-  printf("[Thread %lu] terminated\n", tid);
-  pthread_exit(NULL);
+  uring_exit(&server_ring);
 }
 
-/// @brief error function for the serve_client
-/// @param clientfd file descriptor of the client*
-/// @param newsock socketid of the client as void*
-/// @param newsock buffer for the messages*
-void error_client(int clientfd, void *newsock,char *buffer) {
-  close(clientfd);
-  free(newsock);
-  free(buffer);
+/// @}
 
-  pthread_mutex_lock(&server_ctx.lock);
-  server_ctx.total_queueing--;
-  pthread_mutex_unlock(&server_ctx.lock);
+/// @brief status task answering each connection on the status port with one line describing the
+///        current load: "queue <orders in OrderList> queueing <customers> burgers <burgers made>".
+///        Used by the proxy to balance load and detect stuck backends.
+void* status_task(void *dummy)
+{
+  char line[96];
+  unsigned int queue, queueing, burgers;
+  int fd, len, i;
+
+  while (keep_running) {
+    fd = accept(statusfd, NULL, NULL);
+    if (fd < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+
+    lockstat_lock(&server_ctx.lock);
+    queue = server_ctx.list.count;
+    queueing = server_ctx.total_queueing;
+    for (burgers = 0, i = 0; i < BURGER_TYPE_MAX; i++) burgers += server_ctx.total_burgers[i];
+    lockstat_unlock(&server_ctx.lock);
+
+    len = snprintf(line, sizeof(line), "queue %u queueing %u burgers %u\n", queue, queueing,
+                   burgers);
+    put_line(fd, line, len);
+    close(fd);
+  }
+
+  return NULL;
 }
 
-/// @brief client task for client thread
-/// @param newsock socketID of the client as void*
-void* serve_client(void *newsock)
+/// @brief start the status listener if a status port was given
+void start_status(void)
 {
-  ssize_t read, sent;             // size of read and sent message
-  size_t msglen;                  // message buffer size
-  char *message, *buffer;         // message buffers
-  char *burger;                   // parsed burger string
-  unsigned int customerID;        // customer ID
-  enum burger_type *types;        // list of burger types
-  Node **order_list = NULL;       // list of orders issued
-  int ret, i, clientfd;           // misc. values
-  unsigned int burger_count = 0;  // number of burgers in request
-  Node *first_order;              // first order of requests
+  if (status_port == 0) return;
 
-  clientfd = *(int *) newsock;
-  buffer = (char *) malloc(BUF_SIZE);
-  msglen = BUF_SIZE;
+  statusfd = open_listenfd(status_port);
+  if (statusfd < 0) {
+    printf("Error: cannot bind to status port %d\n", status_port);
+    return;
+  }
 
-  // Get customer ID
-  pthread_mutex_lock(&server_ctx.lock);
-  customerID = server_ctx.total_customers++;
-  pthread_mutex_unlock(&server_ctx.lock);
+  pthread_create(&status_thread, NULL, status_task, NULL);
+  pthread_detach(status_thread);
+}
 
-  printf("Customer #%d visited\n", customerID);
+/// @brief accept task of the shared-memory transport: every client connecting to the Unix socket
+///        gets its own channel and is served by serve_client() like a TCP customer
+void* shm_task(void *dummy)
+{
+  struct shm_endpoint *ep;
+  struct timespec accepted;
+
+  while (keep_running) {
+    ep = shm_accept(shmfd);
+    if (ep == NULL) {
+      if ((errno == EINTR) || (errno == ECONNABORTED)) continue;
+      perror("shm_accept");
+      break;
+    }
 
-  // Generate welcome message
-  ret = asprintf(&message, "Welcome to McDonald's, customer #%d\n", customerID);
-  if (ret < 0) {
-    perror("asprintf");
-    return NULL;
+    clock_gettime(CLOCK_MONOTONIC, &accepted);
+    admit_customer(-1, ep, &accepted);
   }
 
-  // Send welcome to mcdonalds
-  sent = put_line(clientfd, message, ret);
-  if (sent < 0) {
-    printf("Error: cannot send data to client\n");
-    error_client(clientfd, newsock, buffer);
-    return NULL;
+  return NULL;
+}
+
+/// @brief start the shared-memory transport if a socket path was given
+void start_shm(void)
+{
+  if (shm_path == NULL) return;
+
+  shmfd = shm_listen(shm_path);
+  if (shmfd < 0) {
+    perror(shm_path);
+    return;
   }
-  free(message);
 
-  // Receive request from the customer
-  // TODO
+  pthread_once(&serve_pool_once, start_serve_pool);
+  pthread_create(&shm_thread, NULL, shm_task, NULL);
+  pthread_detach(shm_thread);
+}
 
-  // Parse and split request from the customer into orders
-  // - Fill in `types` variable with each parsed burger type and increase `burger_count`
-  // - While parsing, if burger is not an available type, exit connection
-  // - Tip: try using strtok_r() with while statement
-  // TODO
+/// @brief wait for the requests recovered from the journal. Their customers are gone, so the
+///        burgers are only announced as ready before the requests are released.
+/// @param data NULL-terminated array of Node lists returned by queue_orders()
+void* recover_task(void *data)
+{
+  Node ***lists = (Node ***)data;
+  Node *first_order;
+  unsigned int i;
 
-  // Issue orders to kitchen and wait
-  // - Tip: use pthread_cond_wait() to wait
-  // - Tip2: use issue_orders() to issue request
-  // - Tip3: all orders in a request share the same `cond` and `cond_mutex`,
-  //         so access such variables through the first order
-  // TODO
+  for (i = 0; lists[i] != NULL; i++) {
+    first_order = lists[i][0];
 
-  // If request is successfully handled, hand ordered burgers and say goodbye
-  // All orders share the same `remain_count`, so access it through the first order
-  if (*(first_order->remain_count) == 0) {
-    ret = asprintf(&message, "Your order(%s) is ready! Goodbye!\n", *(first_order->order_str));
-    sent = put_line(clientfd, message, ret);
-    if (sent <= 0) {
-      printf("Error: cannot send data to client\n");
-      error_client(clientfd, newsock, buffer);
-      return NULL;
+    lockstat_lock(first_order->cond_mutex);
+    while (order_remain(first_order) > 0) {
+      lockstat_cond_wait(first_order->cond, first_order->cond_mutex);
     }
-    free(*(first_order->order_str));
-    free(message);
+    lockstat_unlock(first_order->cond_mutex);
+
+    printf("Recovered order of customer #%u is ready\n", first_order->customerID);
+    free_orders(lists[i], order_journal.recovered[i].burger_count);
   }
 
-  pthread_cond_destroy(first_order->cond);
-  pthread_mutex_destroy(first_order->cond_mutex);
+  free(lists);
+  return NULL;
+}
 
-  // If any, free unused variables
-  // TODO
+/// @brief open the order journal if a path was given and requeue the requests that were accepted
+///        but not finished before the previous run of the server stopped
+void start_journal(void)
+{
+  struct journal_order *o;
+  Node ***lists;
+  pthread_t tid;
+  unsigned int i;
 
-  close(clientfd);
-  free(newsock);
-  free(buffer);
+  if (journal_path == NULL) return;
 
-  pthread_mutex_lock(&server_ctx.lock);
-  server_ctx.total_queueing--;
-  pthread_mutex_unlock(&server_ctx.lock);
+  if (journal_open(&order_journal, journal_path) < 0) {
+    perror(journal_path);
+    return;
+  }
+  journal = &order_journal;
 
-  return NULL;
+  // continue numbering after the customers recorded in the journal
+  lockstat_lock(&server_ctx.lock);
+  if (server_ctx.total_customers < order_journal.next_id) {
+    server_ctx.total_customers = order_journal.next_id;
+  }
+  publish_stats();
+  lockstat_unlock(&server_ctx.lock);
+
+  if (order_journal.recovered_count == 0) return;
+
+  // the compacted journal already holds these requests, so they are queued without journaling
+  lists = (Node ***)malloc(sizeof(Node **) * (order_journal.recovered_count + 1));
+  for (i = 0; i < order_journal.recovered_count; i++) {
+    o = &order_journal.recovered[i];
+    printf("Recovered %u burger(s) for customer #%u\n", o->burger_count, o->customerID);
+    lists[i] = queue_orders(o->customerID, o->types, o->burger_count,
+                            DEADLINE_NONE, false, NULL);
+  }
+  lists[i] = NULL;
+
+  pthread_create(&tid, NULL, recover_task, lists);
+  pthread_detach(tid);
 }
 
-/// @brief start server listening
-void start_server()
+/// @brief create the arrival trace if a path was given. Every parsed request is recorded with its
+///        arrival time, burgers and deadline, so that `client -r` can replay the traffic.
+void start_trace(void)
 {
-  int clientfd, addrlen, opt = 1, *newsock;
-  struct sockaddr_in client;
-  struct addrinfo *ai, *ai_it;
+  if (trace_path == NULL) return;
 
-  // Get socket list by using getsocklist()
-  // TODO
+  if (trace_create(&arrival_trace, trace_path) < 0) {
+    perror(trace_path);
+    return;
+  }
+  trace = &arrival_trace;
+}
 
-  // Iterate over addrinfos and try to bind & listen
-  // TODO
+/// @brief create the statistics file if a path was given. Readers such as mcstat sample it
+///        without taking any lock or issuing any system call in the server.
+void start_stats(void)
+{
+  if (stats_path == NULL) return;
 
-  printf("Listening...\n");
+  stats = stats_create(stats_path);
+  if (stats == NULL) {
+    perror(stats_path);
+    return;
+  }
 
-  // Keep listening and accepting clients
-  // Check if max number of customers is not exceeded after accepting
-  // Create a serve_client thread for the client
-  // TODO
+  lockstat_lock(&server_ctx.lock);
+  publish_stats();
+  lockstat_unlock(&server_ctx.lock);
 }
 
 /// @brief prints overall statistics
 void print_statistics(void)
 {
+  struct buf_stats bufs;
   int i;
 
   printf("\n====== Statistics ======\n");
@@ -418,34 +2135,124 @@ void print_statistics(void)
   for (i = 0; i < BURGER_TYPE_MAX; i++) {
     printf("Number of %s burger made: %u\n", burger_names[i], server_ctx.total_burgers[i]);
   }
+  printf("Number of cancelled requests: %u (saved %u s, wasted %u s of kitchen time)\n",
+         server_ctx.cancelled, server_ctx.saved_burgers * BURGER_COOK_SEC,
+         server_ctx.wasted_burgers * BURGER_COOK_SEC);
+  printf("Number of requests with deadline: %u met, %u missed, %u rejected\n",
+         server_ctx.deadline_met, server_ctx.deadline_missed, server_ctx.rejected);
+  if (server_ctx.handoffs > 0) {
+    printf("Serving pool: %u threads (%u KiB stacks), %lu customers, "
+           "queueing avg %.3f ms, max %.3f ms\n",
+           serve_pool_size, SERVE_STACK_SIZE / 1024, server_ctx.handoffs,
+           server_ctx.handoff_wait_ns * 1e-6 / server_ctx.handoffs,
+           server_ctx.handoff_wait_max_ns * 1e-6);
+  }
+  buf_get_stats(&bufs);
+  printf("Line buffers: %zu B in use (peak %zu B, largest %zu B), %zu B cached, "
+         "%lu/%lu allocations from the pool\n",
+         bufs.in_use, bufs.peak, bufs.largest, bufs.cached, bufs.hits, bufs.allocs);
+  if (server_ctx.conn_closed > 0) {
+    printf("Line buffer per connection: avg %.0f B, max %zu B over %lu connections\n",
+           (double)server_ctx.conn_buf_total / server_ctx.conn_closed, server_ctx.conn_buf_max,
+           server_ctx.conn_closed);
+  }
+  if (pipeline.nstations > 0) kitchen_print_stats(&pipeline);
+  if (trace != NULL) printf("Trace: %lu requests recorded in %s\n", trace->records, trace_path);
+  if (journal != NULL) {
+    printf("Journal: %lu records, %lu commits, %lu fsyncs, %lu compactions\n",
+           journal->records, journal->commits, journal->syncs, journal->compactions);
+  }
+  lockstat_print(stdout);
   printf("\n");
 }
 
+/// @brief make the journal and the trace durable
+void sync_mcdonalds(void)
+{
+  // kitchens may still be appending, so the journal stays mapped until the process exits
+  if (journal != NULL) journal_commit(journal, journal_lsn(journal));
+  if (trace != NULL) trace_flush(trace);
+}
+
 /// @brief exit function
 void exit_mcdonalds(void)
 {
-  pthread_mutex_destroy(&server_ctx.lock);
+  lockstat_destroy(&server_ctx.lock);
   close(listenfd);
+  if (shmfd >= 0) {
+    close(shmfd);
+    unlink(shm_path);
+  }
+  sync_mcdonalds();
   print_statistics();
 }
 
-/// @brief Second SIGINT handler function
-/// @param sig signal number
-void sigint_handler2(int sig)
+/// @brief close McDonald's after the first SIGINT has stopped the server loop. The kitchens get
+///        3 s to finish; a second SIGINT ends the wait and prints the statistics.
+void close_mcdonalds(void)
 {
-  exit_mcdonalds();
+  int i;
+
+  printf("****** I'm tired, closing McDonald's ******\n");
+  for (i = 0; (i < 30) && (interrupts < 2); i++) usleep(100000);
+
+  if (interrupts >= 2) {
+    exit_mcdonalds();
+  } else {
+    sync_mcdonalds();
+    if (shmfd >= 0) unlink(shm_path);
+  }
   exit(EXIT_SUCCESS);
 }
 
-/// @brief First SIGINT handler function
+/// @brief SIGINT handler function. Only async-signal-safe work is done here: the signal is
+///        counted, the threads are told to stop, and the blocked accept of the server loop is
+///        woken up by shutting the listening socket down. The main thread does the rest in
+///        close_mcdonalds().
 /// @param sig signal number
 void sigint_handler(int sig)
 {
-  signal(SIGINT, sigint_handler2);
-  printf("****** I'm tired, closing McDonald's ******\n");
+  interrupts++;
   keep_running = 0;
-  sleep(3);
-  exit(EXIT_SUCCESS);
+  if (listenfd >= 0) shutdown(listenfd, SHUT_RDWR);
+}
+
+/// @brief initializes the server context and the order queue (without starting any threads)
+void init_server_ctx(void)
+{
+  int i;
+
+  lockstat_init(&server_ctx.lock, server_ctx);
+
+  for (i = 0; i < BURGER_TYPE_MAX; i++) {
+    burger_name_len[i] = strlen(burger_names[i]);
+  }
+
+  server_ctx.total_customers = 0;
+  server_ctx.total_queueing = 0;
+  for (i = 0; i < BURGER_TYPE_MAX; i++) {
+    server_ctx.total_burgers[i] = 0;
+  }
+  for (i = 0; i < STATS_LATENCY_BUCKETS; i++) {
+    server_ctx.latency[i] = 0;
+  }
+  server_ctx.cancelled = 0;
+  server_ctx.saved_burgers = 0;
+  server_ctx.wasted_burgers = 0;
+  server_ctx.deadline_met = 0;
+  server_ctx.deadline_missed = 0;
+  server_ctx.rejected = 0;
+  server_ctx.handoffs = 0;
+  server_ctx.handoff_wait_ns = 0;
+  server_ctx.handoff_wait_max_ns = 0;
+  server_ctx.conn_closed = 0;
+  server_ctx.conn_buf_total = 0;
+  server_ctx.conn_buf_max = 0;
+
+  // every burger takes one make_burger(); the simulator may set other cook times
+  for (i = 0; i < BURGER_TYPE_MAX; i++) {
+    burger_cook_ns[i] = BURGER_COOK_SEC * 1000000000ULL;
+  }
 }
 
 /// @brief init function initializes necessary variables and sets SIGINT handler
@@ -485,15 +2292,17 @@ void init_mcdonalds(void)
   printf("\n\n                          I'm lovin it! McDonald's\n\n");
 
   signal(SIGINT, sigint_handler);
-  pthread_mutex_init(&server_ctx.lock, NULL);
+  // a streamed customer may leave between two batches; report that as a failed send instead
+  signal(SIGPIPE, SIG_IGN);
+  init_server_ctx();
 
-  server_ctx.total_customers = 0;
-  server_ctx.total_queueing = 0;
-  for (i = 0; i < BURGER_TYPE_MAX; i++) {
-    server_ctx.total_burgers[i] = 0;
-  }
 
-  pthread_mutex_init(&kitchen_mutex, NULL);
+  if (pipeline.nstations > 0) {
+    if (kitchen_start(&pipeline, pipeline_source, pipeline_finish, &keep_running) < 0) {
+      perror("kitchen_start");
+    }
+    return;
+  }
 
   for (i = 0; i < NUM_KITCHEN; i++) {
     pthread_create(&kitchen_thread[i], NULL, kitchen_task, NULL);
@@ -501,12 +2310,157 @@ void init_mcdonalds(void)
   }
 }
 
+#ifdef MCDONALDS_SIM
+/// @name Simulation hooks
+/// Entry points of the discrete-event simulator (sim.c), which plays the customers, serving
+/// threads and kitchens on the virtual clock `sim_clock`. Queueing, EDF dispatch, deadline
+/// admission and the statistics are the server code above.
+/// @{
+
+/// @brief admit a customer arriving at `sim_clock` (see admit_customer() and serve_client())
+/// @retval customer ID
+/// @retval UINT_MAX if CUSTOMER_MAX customers are already in the server (connection closed)
+unsigned int sim_admit(void)
+{
+  unsigned int customerID = UINT_MAX;
+
+  lockstat_lock(&server_ctx.lock);
+  if (server_ctx.total_queueing < CUSTOMER_MAX) {
+    server_ctx.total_queueing++;
+    customerID = server_ctx.total_customers++;
+  }
+  lockstat_unlock(&server_ctx.lock);
+
+  return customerID;
+}
+
+/// @brief set the expected cook time of burger @a type used by deadline admission
+/// @param type burger type
+/// @param ns expected cook time (ns)
+void sim_set_cook_ns(enum burger_type type, uint64_t ns)
+{
+  burger_cook_ns[type] = ns;
+}
+
+/// @brief dequeue the order with the earliest deadline (see get_order())
+/// @param customerID customer of the order. Out parameter.
+/// @param type burger type of the order. Out parameter.
+/// @retval Node* order
+/// @retval NULL if the OrderList is empty
+Node* sim_get_order(unsigned int *customerID, enum burger_type *type)
+{
+  Node *order = get_order();
+
+  if (order != NULL) {
+    *customerID = order->customerID;
+    *type = order->type;
+  }
+  return order;
+}
+
+/// @brief record the burger of a cooked order (see complete_order())
+/// @retval true if every burger of the request is made
+bool sim_complete_order(Node *order)
+{
+  return complete_order(order);
+}
+
+/// @brief let a customer leave at `sim_clock`, after its request has been served or rejected
+/// @param order_list Node list returned by issue_orders(), NULL if the request was rejected
+/// @param burger_count number of Nodes in @a order_list
+/// @param start arrival time of the customer (ns)
+void sim_depart(Node **order_list, unsigned int burger_count, uint64_t start)
+{
+  struct timespec accepted = { start / 1000000000ULL, start % 1000000000ULL };
+
+  if (order_list != NULL) {
+    account_deadline(order_list[0]);
+    free_orders(order_list, burger_count);
+  }
+
+  lockstat_lock(&server_ctx.lock);
+  server_ctx.total_queueing--;
+  if (order_list != NULL) record_latency(&accepted);
+  lockstat_unlock(&server_ctx.lock);
+}
+
+/// @}
+#endif // MCDONALDS_SIM
+
+#ifndef MCDONALDS_NO_MAIN
 /// @brief program entry point
 int main(int argc, char *argv[])
 {
+  int opt;
+
+  while ((opt = getopt(argc, argv, "b:j:k:m:o:p:s:t:u:w:")) != -1) {
+    switch (opt) {
+      case 'b':
+        if (strcmp(optarg, "thread") == 0) backend = BACKEND_THREAD;
+        else if (strcmp(optarg, "uring") == 0) backend = BACKEND_URING;
+        else {
+          printf("unknown backend '%s'\n", optarg);
+          return EXIT_FAILURE;
+        }
+        break;
+      case 'j':
+        journal_path = optarg;
+        break;
+      case 'k':
+        if (kitchen_parse(&pipeline, optarg) < 0) {
+          printf("invalid kitchen stations '%s' (name:workers:service_ms[:queue],...)\n", optarg);
+          return EXIT_FAILURE;
+        }
+        break;
+      case 'm':
+        stats_path = optarg;
+        break;
+      case 'o':
+        if (net_parse_option(&net_opt, optarg) < 0) {
+          printf("unknown socket option '%s'\n", optarg);
+          return EXIT_FAILURE;
+        }
+        break;
+      case 'p':
+        port = atoi(optarg);
+        break;
+      case 's':
+        status_port = atoi(optarg);
+        break;
+      case 't':
+        trace_path = optarg;
+        break;
+      case 'u':
+        shm_path = optarg;
+        break;
+      case 'w':
+        serve_pool_size = atoi(optarg);
+        if ((serve_pool_size == 0) || (serve_pool_size > CUSTOMER_MAX)) {
+          printf("serving threads must be between 1 and %d\n", CUSTOMER_MAX);
+          return EXIT_FAILURE;
+        }
+        break;
+      default:
+        printf("usage ./mcdonalds [-b thread|uring] [-j journal] [-k stations] [-m stats_file] "
+               "[-o option=value] [-p port] [-s status_port] [-t trace_file] [-u shm_socket] "
+               "[-w serving_threads]\n");
+        return EXIT_FAILURE;
+    }
+  }
+
   init_mcdonalds();
-  start_server();
+  start_stats();
+  start_journal();
+  start_trace();
+  start_status();
+  start_shm();
+  if (backend == BACKEND_URING) start_server_uring();
+  else start_server();
+
+  // the server loop also returns if it could not be started
+  if (!keep_running) close_mcdonalds();
   exit_mcdonalds();
 
   return 0;
 }
+#endif // MCDONALDS_NO_MAIN
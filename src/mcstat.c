@@ -0,0 +1,138 @@
+//--------------------------------------------------------------------------------------------------
+// Network Lab                             Spring 2024                           System Programming
+//
+/// @file
+/// @brief Statistics reader sampling the memory-mapped statistics file of a running mcdonalds
+///
+/// @section changelog Change Log
+/// 2026/10/18 ARC lab created
+///
+/// @section license_section License
+/// Copyright (c) 2024-2026, Architecture and Code Optimization Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS  BE LIABLE FOR ANY DIRECT,  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY,  OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS; OR BUSINESS INTERRUPTION)  HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <unistd.h>
+
+#include "stats.h"
+#include "burger.h"
+
+#define SAMPLE_INTERVAL 1000                                ///< default sampling interval (ms)
+
+/// @brief latency bucket holding the @a pct percentile of @a hist
+/// @retval -1 if @a hist is empty
+static int latency_percentile(const uint64_t *hist, double pct)
+{
+  uint64_t total = 0, seen = 0;
+  int i;
+
+  for (i = 0; i < STATS_LATENCY_BUCKETS; i++) total += hist[i];
+  if (total == 0) return -1;
+
+  for (i = 0; i < STATS_LATENCY_BUCKETS; i++) {
+    seen += hist[i];
+    if (seen >= total * pct) break;
+  }
+  return i;
+}
+
+/// @brief print the bound of latency bucket @a b; the last bucket has no upper bound
+static void print_latency(int b)
+{
+  char bound[24] = "-";
+
+  if (b == STATS_LATENCY_BUCKETS - 1) snprintf(bound, sizeof(bound), ">=%ld", 1L << (b - 1));
+  else if (b >= 0) snprintf(bound, sizeof(bound), "<%ld", 1L << b);
+  printf(" %8s", bound);
+}
+
+/// @brief program entry point
+int main(int argc, char *argv[])
+{
+  const struct stats_page *page;
+  struct stats_page prev, cur;
+  struct timespec next;
+  uint64_t burgers, prev_burgers, delta[STATS_LATENCY_BUCKETS];
+  long interval = SAMPLE_INTERVAL, samples = -1, n;
+  double secs;
+  int opt, i;
+
+  while ((opt = getopt(argc, argv, "i:n:")) != -1) {
+    if (opt == 'i') interval = atol(optarg);
+    else if (opt == 'n') samples = atol(optarg);
+    else optind = argc + 1;
+  }
+
+  if ((argc - optind != 1) || (interval <= 0)) {
+    printf("usage ./mcstat [-i interval_ms] [-n samples] <stats_file>\n");
+    return EXIT_FAILURE;
+  }
+
+  page = stats_open(argv[optind]);
+  if (page == NULL) {
+    perror(argv[optind]);
+    return EXIT_FAILURE;
+  }
+
+  secs = interval * 1e-3;
+  stats_snapshot(page, &prev);
+  clock_gettime(CLOCK_MONOTONIC, &next);
+
+  printf("%10s %10s %10s %10s %8s %8s %8s %8s %9s %8s %8s\n",
+         "customers", "cust/s", "burgers", "burg/s", "queue", "inflight", "p50_ms", "p99_ms",
+         "cancelled", "saved", "wasted");
+
+  for (n = 0; (samples < 0) || (n < samples); n++) {
+    next.tv_nsec += (interval % 1000) * 1000000L;
+    next.tv_sec += interval / 1000 + next.tv_nsec / 1000000000L;
+    next.tv_nsec %= 1000000000L;
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+    stats_snapshot(page, &cur);
+
+    for (burgers = prev_burgers = 0, i = 0; i < BURGER_TYPE_MAX; i++) {
+      burgers += cur.burgers[i];
+      prev_burgers += prev.burgers[i];
+    }
+    for (i = 0; i < STATS_LATENCY_BUCKETS; i++) delta[i] = cur.latency[i] - prev.latency[i];
+
+    printf("%10lu %10.1f %10lu %10.1f %8lu %8lu",
+           (unsigned long)cur.customers, (cur.customers - prev.customers) / secs,
+           (unsigned long)burgers, (burgers - prev_burgers) / secs,
+           (unsigned long)cur.queue, (unsigned long)cur.inflight);
+    print_latency(latency_percentile(delta, 0.50));
+    print_latency(latency_percentile(delta, 0.99));
+    printf(" %9lu %8lu %8lu\n", (unsigned long)cur.cancelled, (unsigned long)cur.saved,
+           (unsigned long)cur.wasted);
+    fflush(stdout);
+
+    prev = cur;
+  }
+
+  return EXIT_SUCCESS;
+}
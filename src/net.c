@@ -10,6 +10,8 @@
 /// 2017/11/24 Bernhard Egger added put/get_line functions
 /// 2017/12/06 Bernhard Egger added getsocklist() & cleanup
 /// 2020/11/25 Bernhard Egger cleanup & minor bugfixes
+/// 2026/10/18 ARC lab added open_listenfd() & open_clientfd()
+/// 2026/10/18 ARC lab added connection-setup tuning (net_options)
 ///
 /// @section license_section License
 /// Copyright (c) 2016-2023, Computer Systems and Platforms Laboratory, SNU
@@ -39,12 +41,17 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <pthread.h>
 
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
 
 #include "net.h"
+#include "lockstat.h"
 
 struct addrinfo *getsocklist(const char *host, unsigned short port, int family, int type, 
                              int listening, int *res)
@@ -68,6 +75,101 @@ struct addrinfo *getsocklist(const char *host, unsigned short port, int family,
   else return ai;
 }
 
+static const struct net_options net_defaults = NET_OPTIONS_DEFAULT;
+
+int open_listenfd(unsigned short port)
+{
+  return open_listenfd_opt(port, NULL);
+}
+
+int open_listenfd_opt(unsigned short port, const struct net_options *opt)
+{
+  struct addrinfo *ai, *ai_it;
+  int fd = -1, one = 1;
+
+  if (opt == NULL) opt = &net_defaults;
+
+  ai = getsocklist(NULL, port, AF_UNSPEC, SOCK_STREAM, 1, NULL);
+  if (ai == NULL) return -1;
+
+  for (ai_it = ai; ai_it != NULL; ai_it = ai_it->ai_next) {
+    fd = socket(ai_it->ai_family, ai_it->ai_socktype | SOCK_CLOEXEC, ai_it->ai_protocol);
+    if (fd < 0) continue;
+
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (opt->nodelay) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (opt->defer_accept > 0) {
+      setsockopt(fd, IPPROTO_TCP, TCP_DEFER_ACCEPT, &opt->defer_accept, sizeof(int));
+    }
+    if (opt->fastopen > 0) {
+      setsockopt(fd, IPPROTO_TCP, TCP_FASTOPEN, &opt->fastopen, sizeof(int));
+    }
+
+    if ((bind(fd, ai_it->ai_addr, ai_it->ai_addrlen) == 0) && (listen(fd, opt->backlog) == 0)) {
+      break;
+    }
+
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(ai);
+
+  return fd;
+}
+
+int open_clientfd(const char *host, unsigned short port)
+{
+  return open_clientfd_opt(host, port, NULL);
+}
+
+int open_clientfd_opt(const char *host, unsigned short port, const struct net_options *opt)
+{
+  struct addrinfo *ai, *ai_it;
+  int fd = -1, one = 1;
+
+  if (opt == NULL) opt = &net_defaults;
+
+  ai = getsocklist(host, port, AF_UNSPEC, SOCK_STREAM, 0, NULL);
+  if (ai == NULL) return -1;
+
+  for (ai_it = ai; ai_it != NULL; ai_it = ai_it->ai_next) {
+    fd = socket(ai_it->ai_family, ai_it->ai_socktype | SOCK_CLOEXEC, ai_it->ai_protocol);
+    if (fd < 0) continue;
+
+    if (opt->nodelay) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (opt->fastopen > 0) {
+      setsockopt(fd, IPPROTO_TCP, TCP_FASTOPEN_CONNECT, &one, sizeof(one));
+    }
+
+    if (connect(fd, ai_it->ai_addr, ai_it->ai_addrlen) == 0) break;
+
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(ai);
+
+  return fd;
+}
+
+int net_parse_option(struct net_options *opt, const char *arg)
+{
+  const char *eq = strchr(arg, '=');
+  char *end;
+  long v;
+
+  if (eq == NULL) return -1;
+  v = strtol(eq + 1, &end, 10);
+  if ((end == eq + 1) || (*end != '\0') || (v < 0)) return -1;
+
+  if (strncmp(arg, "backlog=", 8) == 0) opt->backlog = v > 0 ? (int)v : 1;
+  else if (strncmp(arg, "nodelay=", 8) == 0) opt->nodelay = (v != 0);
+  else if (strncmp(arg, "defer=", 6) == 0) opt->defer_accept = (int)v;
+  else if (strncmp(arg, "fastopen=", 9) == 0) opt->fastopen = (int)v;
+  else return -1;
+
+  return 0;
+}
+
 void dump_sockaddr(struct sockaddr *sa)
 {
   char adrstr[40];
@@ -157,10 +259,7 @@ int get_line(int sock, char **buf, size_t *cur_len)
       (*buf)[pos++] = c;
 
       // allocate more memory for buf if necessary
-      if (pos == *cur_len) {
-        *cur_len <<= 1;
-        *buf = (char *)realloc(*buf, *cur_len);
-      }
+      if (pos == *cur_len) *buf = buf_grow(*buf, cur_len);
     }
   } while ((res == 1) && (c != '\n'));
 
@@ -200,3 +299,120 @@ int put_line(int sock, char *buf, size_t len)
   return res;
 }
 
+
+/// @internal
+/// @brief free list of one buffer size class, linked through the first bytes of the buffers
+struct buf_class {
+  lockstat_mutex_t lock;                                    ///< protects the fields below
+  void *free;                                               ///< first free buffer
+  unsigned int count;                                       ///< number of free buffers
+};
+
+LOCKSTAT_CLASS(buf_pool);                                   ///< `lock` of every buffer size class
+
+static struct buf_class buf_classes[BUF_CLASS_COUNT] = {
+  [0 ... BUF_CLASS_COUNT - 1] = { LOCKSTAT_MUTEX_INITIALIZER(buf_pool), NULL, 0 }
+};
+static struct buf_stats buf_acct;                           ///< updated with atomic operations
+
+/// @brief size class of a buffer of @a len bytes (a power of two), -1 if it is not pooled
+static int buf_class_of(size_t len)
+{
+  int c = 0;
+
+  while ((BUF_INITIAL << c) < len) c++;
+  return c < BUF_CLASS_COUNT ? c : -1;
+}
+
+/// @brief raise *@a max to @a v
+static void buf_acct_max(size_t *max, size_t v)
+{
+  size_t cur = __atomic_load_n(max, __ATOMIC_RELAXED);
+
+  while ((v > cur) &&
+         !__atomic_compare_exchange_n(max, &cur, v, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) ;
+}
+/// @endinternal
+
+char *buf_alloc(size_t *len)
+{
+  struct buf_class *bc;
+  size_t size = BUF_INITIAL;
+  char *buf = NULL;
+  int c;
+
+  while (size < *len) size <<= 1;
+  *len = size;
+
+  c = buf_class_of(size);
+  if (c >= 0) {
+    bc = &buf_classes[c];
+    lockstat_lock(&bc->lock);
+    if (bc->free != NULL) {
+      buf = (char *)bc->free;
+      bc->free = *(void **)buf;
+      bc->count--;
+    }
+    lockstat_unlock(&bc->lock);
+  }
+
+  __atomic_add_fetch(&buf_acct.allocs, 1, __ATOMIC_RELAXED);
+  if (buf != NULL) {
+    __atomic_add_fetch(&buf_acct.hits, 1, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&buf_acct.cached, size, __ATOMIC_RELAXED);
+  } else {
+    buf = (char *)malloc(size);
+  }
+
+  buf_acct_max(&buf_acct.peak, __atomic_add_fetch(&buf_acct.in_use, size, __ATOMIC_RELAXED));
+  buf_acct_max(&buf_acct.largest, size);
+
+  return buf;
+}
+
+char *buf_grow(char *buf, size_t *len)
+{
+  size_t new_len = *len << 1;
+  char *new_buf = buf_alloc(&new_len);
+
+  memcpy(new_buf, buf, *len);
+  buf_free(buf, *len);
+  *len = new_len;
+
+  return new_buf;
+}
+
+void buf_free(char *buf, size_t len)
+{
+  struct buf_class *bc;
+  int c = buf_class_of(len);
+
+  if (buf == NULL) return;
+
+  __atomic_sub_fetch(&buf_acct.in_use, len, __ATOMIC_RELAXED);
+
+  if (c >= 0) {
+    bc = &buf_classes[c];
+    lockstat_lock(&bc->lock);
+    if (bc->count < BUF_POOL_DEPTH) {
+      *(void **)buf = bc->free;
+      bc->free = buf;
+      bc->count++;
+      buf = NULL;
+    }
+    lockstat_unlock(&bc->lock);
+  }
+
+  if (buf == NULL) __atomic_add_fetch(&buf_acct.cached, len, __ATOMIC_RELAXED);
+  else free(buf);
+}
+
+void buf_get_stats(struct buf_stats *s)
+{
+  s->in_use = __atomic_load_n(&buf_acct.in_use, __ATOMIC_RELAXED);
+  s->peak = __atomic_load_n(&buf_acct.peak, __ATOMIC_RELAXED);
+  s->cached = __atomic_load_n(&buf_acct.cached, __ATOMIC_RELAXED);
+  s->largest = __atomic_load_n(&buf_acct.largest, __ATOMIC_RELAXED);
+  s->allocs = __atomic_load_n(&buf_acct.allocs, __ATOMIC_RELAXED);
+  s->hits = __atomic_load_n(&buf_acct.hits, __ATOMIC_RELAXED);
+}
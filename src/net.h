@@ -10,6 +10,7 @@
 /// 2017/11/24 Bernhard Egger added put/get_line functions
 /// 2017/12/06 Bernhard Egger added getsocklist() & cleanup
 /// 2020/11/25 Bernhard Egger cleanup & minor bugfixes
+/// 2026/10/18 ARC lab added open_listenfd() & open_clientfd()
 ///
 /// @section license_section License
 /// Copyright (c) 2016-2023, Computer Systems and Platforms Laboratory, SNU
@@ -36,9 +37,22 @@
 //--------------------------------------------------------------------------------------------------
 
 #ifndef __NET_H__
+#define __NET_H__
 
+#include <stddef.h>
 #include <sys/socket.h>
 
+/// @brief TCP connection-setup tuning applied by open_listenfd_opt() and open_clientfd_opt()
+struct net_options {
+  int backlog;                                              ///< listen backlog
+  int nodelay;                                              ///< set TCP_NODELAY (disable Nagle)
+  int defer_accept;                                         ///< TCP_DEFER_ACCEPT seconds (0: off)
+  int fastopen;                                             ///< TCP_FASTOPEN queue length (0: off)
+};
+
+/// @brief default tuning: full backlog and TCP_NODELAY for the short request/reply lines
+#define NET_OPTIONS_DEFAULT { SOMAXCONN, 1, 0, 0 }
+
 /// @name network helper functions
 /// @{
 
@@ -55,6 +69,49 @@
 struct addrinfo *getsocklist(const char *host, unsigned short port, int family, int type, 
                              int listening, int *res);
 
+/// @brief create a TCP socket bound to @a port on all local addresses and start listening with
+///        the default net_options.
+/// @param port port
+/// @retval >=0 listening socket
+/// @retval -1 error (no address could be bound)
+int open_listenfd(unsigned short port);
+
+/// @brief create a listening TCP socket like open_listenfd() with tuning @a opt. TCP_NODELAY is
+///        set on the listening socket and inherited by the accepted sockets, so the accept path
+///        does not need an extra setsockopt() per connection. TCP_DEFER_ACCEPT delays accept()
+///        until the client has sent data; since the server speaks first in the McDonald's
+///        protocol, it only pays off for client-first protocols.
+/// @param port port
+/// @param opt tuning options (NULL: defaults)
+/// @retval >=0 listening socket
+/// @retval -1 error (no address could be bound)
+int open_listenfd_opt(unsigned short port, const struct net_options *opt);
+
+/// @brief create a TCP socket connected to @a host:@a port with the default net_options.
+/// @param host host string (URL or IP in decimal dotted notation)
+/// @param port port
+/// @retval >=0 connected socket
+/// @retval -1 error (no address could be connected)
+int open_clientfd(const char *host, unsigned short port);
+
+/// @brief create a connected TCP socket like open_clientfd() with tuning @a opt. A non-zero
+///        @a opt->fastopen enables TCP_FASTOPEN_CONNECT: the first data written is carried in the
+///        SYN once the client holds a fast-open cookie for the server.
+/// @param host host string (URL or IP in decimal dotted notation)
+/// @param port port
+/// @param opt tuning options (NULL: defaults, backlog and defer_accept are ignored)
+/// @retval >=0 connected socket
+/// @retval -1 error (no address could be connected)
+int open_clientfd_opt(const char *host, unsigned short port, const struct net_options *opt);
+
+/// @brief parse one tuning option of the form "name=value" (backlog, nodelay, defer, fastopen)
+///        into @a opt.
+/// @param opt options to update
+/// @param arg option string
+/// @retval 0 success
+/// @retval -1 unknown option or invalid value
+int net_parse_option(struct net_options *opt, const char *arg);
+
 /// @brief dump a sockaddr structure to stdout in human readable form.
 /// @param sa pointer to sockaddr struct
 void dump_sockaddr(struct sockaddr *sa);
@@ -88,11 +145,55 @@ int put_data(int sock, char *buf, size_t len);
 
 /// @}
 
+/// @name line buffer pool
+/// Line buffers start small and grow on demand. Freed buffers of up to BUF_SIZE bytes are kept
+/// in per-size-class free lists shared by all connections, so a connection holds only as much
+/// buffer memory as its longest line needs and the allocator is rarely involved.
+/// @{
+
+#define BUF_INITIAL 128                                     ///< initial size of a line buffer
+#define BUF_CLASS_COUNT 10                                  ///< size classes 128 B .. 64 KiB
+#define BUF_POOL_DEPTH 64                                   ///< free buffers kept per size class
+
+/// @brief line buffer memory accounting
+struct buf_stats {
+  size_t in_use;                                            ///< bytes held by connections
+  size_t peak;                                              ///< maximum of @a in_use
+  size_t cached;                                            ///< bytes in the free lists
+  size_t largest;                                           ///< largest buffer handed out
+  unsigned long allocs;                                     ///< buf_alloc() calls
+  unsigned long hits;                                       ///< allocations served by the pool
+};
+
+/// @brief allocate a line buffer of at least @a len bytes (at least BUF_INITIAL). Sizes are
+///        rounded up to a power of two.
+/// @param len requested size. In/out parameter: set to the size of the buffer.
+/// @retval buffer, to be released with buf_free()
+char *buf_alloc(size_t *len);
+
+/// @brief double the size of a line buffer, keeping its contents
+/// @param buf buffer returned by buf_alloc() or buf_grow()
+/// @param len size of @a buf. In/out parameter.
+/// @retval new buffer (@a buf has been released)
+char *buf_grow(char *buf, size_t *len);
+
+/// @brief release a line buffer to the pool
+/// @param buf buffer returned by buf_alloc() or buf_grow(), or NULL
+/// @param len size of @a buf
+void buf_free(char *buf, size_t len);
+
+/// @brief get a snapshot of the line buffer accounting
+/// @param s statistics. Out parameter.
+void buf_get_stats(struct buf_stats *s);
+
+/// @}
+
 /// @name sending/receiving of '\n'-terminated strings
 /// @{
 
-/// @brief read a '\\n'-terminated line from @a sock into @a buf. @a Buf is reallocated if neces-
-///        sary. Blocks until one line has been read, and survives interrupts caused by signals.
+/// @brief read a '\\n'-terminated line from @a sock into @a buf. @a Buf must come from
+///        buf_alloc() and is grown with buf_grow() if necessary. Blocks until one line has been
+///        read, and survives interrupts caused by signals.
 /// @param sock socket to read from
 /// @param buf data buffer. In/out parameter.
 /// @param cur_len length of data buffer. In/out parameter.
@@ -0,0 +1,391 @@
+//--------------------------------------------------------------------------------------------------
+// Network Lab                             Spring 2024                           System Programming
+//
+/// @file
+/// @brief Load-balancing proxy spreading customers over several mcdonalds backends
+///
+/// @section changelog Change Log
+/// 2026/10/18 ARC lab created
+///
+/// @section license_section License
+/// Copyright (c) 2024-2026, Architecture and Code Optimization Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS  BE LIABLE FOR ANY DIRECT,  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY,  OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS; OR BUSINESS INTERRUPTION)  HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <signal.h>
+#include <pthread.h>
+#include <errno.h>
+#include <ctype.h>
+#include <poll.h>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "net.h"
+#include "burger.h"
+
+/// @name Constant definitions
+/// @{
+
+#define MAX_BACKENDS 16                                     ///< maximum number of backends
+#define CHECK_INTERVAL 200                                  ///< default health-check interval (ms)
+#define STALL_TIMEOUT 5000                                  ///< time without progress = stuck (ms)
+
+/// @}
+
+/// @name Structures
+/// @{
+
+/// @brief backend mcdonalds instance on the loopback interface
+struct backend {
+  unsigned short port;                                      ///< customer port
+  unsigned short status_port;                               ///< status port (mcdonalds -s)
+  bool healthy;                                             ///< eligible for new customers
+  unsigned int queue;                                       ///< queue depth at last probe
+  unsigned int burgers;                                     ///< burgers made at last probe
+  unsigned int stalls;                                      ///< probes without progress
+  unsigned int inflight;                                    ///< orders forwarded, not yet served
+  unsigned long customers;                                  ///< customers forwarded
+};
+
+/// @}
+
+/// @name Global variables
+/// @{
+
+unsigned short port = PORT;                                 ///< customer port of the proxy
+unsigned int check_interval = CHECK_INTERVAL;               ///< health-check interval (ms)
+struct backend backends[MAX_BACKENDS];                      ///< backend pool
+int num_backends = 0;                                       ///< number of backends
+pthread_mutex_t backend_lock = PTHREAD_MUTEX_INITIALIZER;   ///< protects backends
+int listenfd = -1;                                          ///< listen file descriptor
+volatile sig_atomic_t keep_running = 1;                     ///< cleared by SIGINT
+
+/// @}
+
+/// @brief load estimate of a backend: the reported queue depth lags behind by up to one check
+///        interval, the in-flight count only covers customers of this proxy; use the larger one
+static unsigned int backend_load(struct backend *b)
+{
+  return b->queue > b->inflight ? b->queue : b->inflight;
+}
+
+/// @brief pick the healthy backend with the least outstanding orders
+/// @param tried bitmask of backends that already failed for this customer
+/// @retval backend index or -1 if no backend is available
+int pick_backend(unsigned int tried)
+{
+  int i, best = -1;
+
+  pthread_mutex_lock(&backend_lock);
+  for (i = 0; i < num_backends; i++) {
+    if (!backends[i].healthy || (tried & (1u << i))) continue;
+    if ((best < 0) || (backend_load(&backends[i]) < backend_load(&backends[best])) ||
+        ((backend_load(&backends[i]) == backend_load(&backends[best])) &&
+         (backends[i].customers < backends[best].customers))) best = i;
+  }
+  if (best >= 0) backends[best].customers++;
+  pthread_mutex_unlock(&backend_lock);
+
+  return best;
+}
+
+/// @brief change the health state of a backend and log transitions
+static void set_healthy(struct backend *b, bool healthy, const char *reason)
+{
+  if (b->healthy != healthy) {
+    printf("Backend %d %s (%s)\n", b->port, healthy ? "admitted" : "ejected", reason);
+  }
+  b->healthy = healthy;
+}
+
+/// @brief query the status port of a backend and update its health
+void probe_backend(struct backend *b)
+{
+  unsigned int queue, queueing, burgers;
+  struct timeval tv = { check_interval / 1000, (check_interval % 1000) * 1000 };
+  size_t buflen = BUF_INITIAL;
+  char *buffer = buf_alloc(&buflen);
+  int fd, ok = 0;
+
+  fd = open_clientfd(IP, b->status_port);
+  if (fd >= 0) {
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    ok = (get_line(fd, &buffer, &buflen) > 0) &&
+         (sscanf(buffer, "queue %u queueing %u burgers %u", &queue, &queueing, &burgers) == 3);
+    close(fd);
+  }
+  buf_free(buffer, buflen);
+
+  pthread_mutex_lock(&backend_lock);
+  if (!ok) {
+    set_healthy(b, false, "status probe failed");
+  } else {
+    // orders are queued but the kitchens have not made any progress since the last probe
+    if ((queue > 0) && (burgers == b->burgers)) b->stalls++;
+    else b->stalls = 0;
+
+    b->queue = queue;
+    b->burgers = burgers;
+    // idle kitchens sleep 2 s before they look at the queue again, so the stall window must be
+    // clearly longer than that to not eject a backend that has just received new orders
+    if (b->stalls * check_interval >= STALL_TIMEOUT) set_healthy(b, false, "stuck");
+    else set_healthy(b, true, "healthy");
+  }
+  pthread_mutex_unlock(&backend_lock);
+}
+
+/// @brief health-check task probing every backend each check interval
+void* health_task(void *dummy)
+{
+  while (1) {
+    for (int i = 0; i < num_backends; i++) probe_backend(&backends[i]);
+    usleep(check_interval * 1000);
+  }
+  return NULL;
+}
+
+/// @brief count the burgers of a request line
+static unsigned int count_burgers(const char *line)
+{
+  unsigned int count = 0;
+  bool in_token = false;
+
+  for (; *line != '\0'; line++) {
+    bool space = (unsigned char)*line <= ' ';
+    if (!space && !in_token) count++;
+    in_token = !space;
+  }
+  return count;
+}
+
+/// @brief check whether @a line is the header line of a streamed request
+static bool is_stream_header(const char *line, size_t len)
+{
+  while ((len > 0) && isspace((unsigned char)line[len - 1])) len--;
+  return (len == 6) && (memcmp(line, "stream", len) == 0);
+}
+
+/// @brief relay a streamed request byte by byte in both directions until the backend closes the
+///        connection. The burger line goes to the backend as it arrives and every "Ready:" line
+///        comes back right away. A customer that closes its side is passed on as a half-close,
+///        which the backend takes as the customer leaving.
+/// @param clientfd customer socket
+/// @param backendfd backend socket
+/// @param buffer relay buffer
+/// @param buflen size of @a buffer
+static void relay_stream(int clientfd, int backendfd, char *buffer, size_t buflen)
+{
+  struct pollfd pfd[2] = { { clientfd, POLLIN, 0 }, { backendfd, POLLIN, 0 } };
+  ssize_t n;
+
+  while (1) {
+    if (poll(pfd, 2, -1) < 0) {
+      if (errno == EINTR) continue;
+      return;
+    }
+
+    if (pfd[1].revents != 0) {
+      n = recv(backendfd, buffer, buflen, 0);
+      if ((n < 0) && (errno == EINTR)) continue;
+      if ((n <= 0) || (put_data(clientfd, buffer, n) <= 0)) return;
+    }
+
+    if (pfd[0].revents != 0) {
+      n = recv(clientfd, buffer, buflen, 0);
+      if ((n < 0) && (errno == EINTR)) continue;
+      if (n <= 0) {
+        shutdown(backendfd, SHUT_WR);
+        pfd[0].fd = -1;
+      } else if (put_data(backendfd, buffer, n) <= 0) {
+        return;
+      }
+    }
+  }
+}
+
+/// @brief forward one customer to a backend
+/// @param newsock client socket as int*
+void* serve_customer(void *newsock)
+{
+  int clientfd = *(int *)newsock, backendfd = -1, b = -1;
+  unsigned int tried = 0, burgers = 0;
+  size_t buflen = BUF_INITIAL;
+  char *buffer = buf_alloc(&buflen);
+  ssize_t read;
+
+  free(newsock);
+
+  // connect to the least loaded backend that accepts us; a backend that refuses the connection
+  // or closes it before the welcome message (CUSTOMER_MAX reached) is skipped for this customer
+  while ((b = pick_backend(tried)) >= 0) {
+    tried |= 1u << b;
+    backendfd = open_clientfd(IP, backends[b].port);
+    if (backendfd < 0) {
+      pthread_mutex_lock(&backend_lock);
+      set_healthy(&backends[b], false, "connect failed");
+      pthread_mutex_unlock(&backend_lock);
+      continue;
+    }
+    read = get_line(backendfd, &buffer, &buflen);
+    if (read > 0) break;
+    close(backendfd);
+    backendfd = -1;
+  }
+
+  if (backendfd < 0) {
+    printf("Error: no backend available\n");
+    close(clientfd);
+    buf_free(buffer, buflen);
+    return NULL;
+  }
+
+  // welcome: backend -> customer, request: customer -> backend, reply: backend -> customer
+  if (put_line(clientfd, buffer, read) <= 0) goto out;
+
+  read = get_line(clientfd, &buffer, &buflen);
+  if (read <= 0) goto out;
+
+  // streamed requests are relayed as they arrive; their size is not known up front, so they are
+  // not counted as in-flight orders
+  if (is_stream_header(buffer, read)) {
+    if (put_line(backendfd, buffer, read) > 0) relay_stream(clientfd, backendfd, buffer, buflen);
+    goto out;
+  }
+
+  burgers = count_burgers(buffer);
+  pthread_mutex_lock(&backend_lock);
+  backends[b].inflight += burgers;
+  pthread_mutex_unlock(&backend_lock);
+
+  if ((put_line(backendfd, buffer, read) > 0) &&
+      ((read = get_line(backendfd, &buffer, &buflen)) > 0)) {
+    put_line(clientfd, buffer, read);
+  }
+
+  pthread_mutex_lock(&backend_lock);
+  backends[b].inflight -= burgers;
+  pthread_mutex_unlock(&backend_lock);
+
+out:
+  close(backendfd);
+  close(clientfd);
+  buf_free(buffer, buflen);
+  return NULL;
+}
+
+/// @brief prints per-backend statistics
+void print_statistics(void)
+{
+  printf("\n====== Statistics ======\n");
+  pthread_mutex_lock(&backend_lock);
+  for (int i = 0; i < num_backends; i++) {
+    printf("Backend %d: %lu customers, %s\n", backends[i].port, backends[i].customers,
+           backends[i].healthy ? "healthy" : "ejected");
+  }
+  pthread_mutex_unlock(&backend_lock);
+  printf("\n");
+}
+
+/// @brief SIGINT handler function. It only does what is async-signal-safe: the accept loop in
+///        main() is woken up by shutting the listening socket down and prints the statistics.
+/// @param sig signal number
+void sigint_handler(int sig)
+{
+  keep_running = 0;
+  if (listenfd >= 0) shutdown(listenfd, SHUT_RDWR);
+}
+
+/// @brief program entry point
+int main(int argc, char *argv[])
+{
+  int opt, clientfd, *newsock;
+  pthread_t tid;
+  unsigned int bport, sport;
+
+  while ((opt = getopt(argc, argv, "p:i:")) != -1) {
+    switch (opt) {
+      case 'p': port = atoi(optarg); break;
+      case 'i': check_interval = atoi(optarg); break;
+      default: optind = argc + 1; break;
+    }
+  }
+
+  for (; optind < argc; optind++) {
+    if ((num_backends == MAX_BACKENDS) ||
+        (sscanf(argv[optind], "%u:%u", &bport, &sport) != 2)) break;
+    backends[num_backends].port = bport;
+    backends[num_backends].status_port = sport;
+    num_backends++;
+  }
+
+  if ((optind != argc) || (num_backends == 0) || (check_interval == 0)) {
+    printf("usage ./proxy [-p port] [-i check_interval_ms] <port:status_port>...\n");
+    return EXIT_FAILURE;
+  }
+
+  signal(SIGINT, sigint_handler);
+  signal(SIGPIPE, SIG_IGN);
+
+  // probe once so that healthy backends are admitted before the first customer arrives
+  for (int i = 0; i < num_backends; i++) probe_backend(&backends[i]);
+  pthread_create(&tid, NULL, health_task, NULL);
+  pthread_detach(tid);
+
+  listenfd = open_listenfd(port);
+  if (listenfd < 0) {
+    printf("Error: cannot bind to port %d\n", port);
+    return EXIT_FAILURE;
+  }
+
+  printf("Proxy listening on port %d with %d backend(s)...\n", port, num_backends);
+
+  while (keep_running) {
+    clientfd = accept(listenfd, NULL, NULL);
+    if (clientfd < 0) {
+      if (errno == EINTR) continue;
+      // sigint_handler() shuts the listening socket down
+      if (keep_running) perror("accept");
+      break;
+    }
+
+    newsock = (int *)malloc(sizeof(int));
+    *newsock = clientfd;
+    if (pthread_create(&tid, NULL, serve_customer, newsock) != 0) {
+      perror("pthread_create");
+      close(clientfd);
+      free(newsock);
+      continue;
+    }
+    pthread_detach(tid);
+  }
+
+  close(listenfd);
+  print_statistics();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,142 @@
+//--------------------------------------------------------------------------------------------------
+// Network Lab                             Spring 2024                           System Programming
+//
+/// @file  request.c
+/// @brief request line tokenizer mapping burger names to enum burger_type
+///
+/// @section changelog Change Log
+/// 2026/10/18 ARC lab created
+///
+/// @section license_section License
+/// Copyright (c) 2024-2026, Architecture and Code Optimization Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS  BE LIABLE FOR ANY DIRECT,  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY,  OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS; OR BUSINESS INTERRUPTION)  HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "request.h"
+
+/// @internal
+#define BURGER_NAME_MIN  6                                  ///< length of the shortest burger name
+#define BURGER_NAME_MAX  7                                  ///< length of the longest burger name
+
+/// @brief perfect hash over the 2nd and 4th character of the burger names
+#define BURGER_HASH(c1, c3)  ((((unsigned)(c1)) ^ ((unsigned)(c3))) & 7)
+
+/// @brief hash slot -> burger type + 1 (0: empty slot)
+static const unsigned char burger_hash_table[8] = {
+  [BURGER_HASH('i', 'm')] = BURGER_BIGMAC + 1,              // bigmac
+  [BURGER_HASH('h', 'e')] = BURGER_CHEESE + 1,              // cheese
+  [BURGER_HASH('h', 'c')] = BURGER_CHICKEN + 1,             // chicken
+  [BURGER_HASH('u', 'g')] = BURGER_BULGOGI + 1,             // bulgogi
+};
+
+// adding a burger type requires a new table entry; a hash collision would silently drop one
+_Static_assert(BURGER_TYPE_MAX == 4, "update burger_hash_table for the new burger type");
+_Static_assert(__builtin_popcount((1u << BURGER_HASH('i', 'm')) | (1u << BURGER_HASH('h', 'e')) |
+                                  (1u << BURGER_HASH('h', 'c')) | (1u << BURGER_HASH('u', 'g')))
+               == BURGER_TYPE_MAX, "burger_hash_table is not a perfect hash");
+
+#define ONES   0x0101010101010101ULL
+#define HIGHS  0x8080808080808080ULL
+
+/// @brief high bit set in the first byte of @a w that is <= ' ' (whitespace or control character)
+static inline uint64_t word_space(uint64_t w)
+{
+  return (w - ONES * 0x21) & ~w & HIGHS;
+}
+
+/// @brief high bit set in the first byte of @a w that is > ' '
+static inline uint64_t word_nonspace(uint64_t w)
+{
+  return ((w + ONES * (127 - 0x20)) | w) & HIGHS;
+}
+
+/// @brief load 8 bytes in little-endian order from an unaligned address
+static inline uint64_t load_word(const char *p)
+{
+  uint64_t w;
+  memcpy(&w, p, sizeof(w));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  w = __builtin_bswap64(w);
+#endif
+  return w;
+}
+
+/// @brief index of the first byte at or after @a pos for which @a want_space matches
+static size_t scan(const char *line, size_t pos, size_t len, int want_space)
+{
+  uint64_t m;
+
+  while (pos + sizeof(uint64_t) <= len) {
+    uint64_t w = load_word(line + pos);
+    m = want_space ? word_space(w) : word_nonspace(w);
+    if (m) return pos + (__builtin_ctzll(m) >> 3);
+    pos += sizeof(uint64_t);
+  }
+  while ((pos < len) && (((unsigned char)line[pos] <= ' ') != want_space)) pos++;
+
+  return pos;
+}
+/// @endinternal
+
+int burger_lookup(const char *name, size_t len)
+{
+  int type;
+
+  if ((len < BURGER_NAME_MIN) || (len > BURGER_NAME_MAX)) return -1;
+
+  type = (int)burger_hash_table[BURGER_HASH(name[1], name[3])] - 1;
+  if (type < 0) return -1;
+
+  // the hash only selects a candidate; verify the full name
+  if ((memcmp(name, burger_names[type], len) != 0) || (burger_names[type][len] != '\0')) return -1;
+
+  return type;
+}
+
+int request_tokenize(const char *line, size_t len, enum burger_type **types,
+                     unsigned int *capacity)
+{
+  unsigned int count = 0;
+  size_t start, end = 0;
+  int type;
+
+  while (1) {
+    start = scan(line, end, len, 0);
+    if (start == len) break;
+    end = scan(line, start, len, 1);
+
+    type = burger_lookup(line + start, end - start);
+    if (type < 0) return -1;
+
+    if (count == *capacity) {
+      *capacity = *capacity ? *capacity << 1 : 4;
+      *types = (enum burger_type *)realloc(*types, sizeof(enum burger_type) * *capacity);
+    }
+    (*types)[count++] = type;
+  }
+
+  return count;
+}
@@ -0,0 +1,65 @@
+//--------------------------------------------------------------------------------------------------
+// Network Lab                             Spring 2024                           System Programming
+//
+/// @file  request.h
+/// @brief request line tokenizer mapping burger names to enum burger_type
+///
+/// @section changelog Change Log
+/// 2026/10/18 ARC lab created
+///
+/// @section license_section License
+/// Copyright (c) 2024-2026, Architecture and Code Optimization Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS  BE LIABLE FOR ANY DIRECT,  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY,  OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS; OR BUSINESS INTERRUPTION)  HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#ifndef __REQUEST_H__
+#define __REQUEST_H__
+
+#include <stddef.h>
+
+#include "burger.h"
+
+/// @name request parsing
+/// @{
+
+/// @brief map a burger name to its type with a compile-time perfect hash and one memcmp().
+/// @param name burger name (not necessarily '\0'-terminated)
+/// @param len  length of @a name
+/// @retval >=0 burger type
+/// @retval -1  unknown burger
+int burger_lookup(const char *name, size_t len);
+
+/// @brief split a request line into burger types in a single pass. Whitespace (any byte <= ' ')
+///        is skipped eight bytes at a time. @a types is grown with realloc() as needed, so
+///        requests with thousands of burgers are supported.
+/// @param line     request line (not necessarily '\0'-terminated)
+/// @param len      length of @a line
+/// @param types    array of parsed types. In/out parameter.
+/// @param capacity number of entries allocated in @a types. In/out parameter.
+/// @retval >=0 number of parsed burgers
+/// @retval -1  the request contains an unknown burger
+int request_tokenize(const char *line, size_t len, enum burger_type **types,
+                     unsigned int *capacity);
+
+/// @}
+
+#endif // __REQUEST_H__
@@ -0,0 +1,292 @@
+//--------------------------------------------------------------------------------------------------
+// Network Lab                             Spring 2024                           System Programming
+//
+/// @file  shm.c
+/// @brief shared-memory transport for clients running on the same host as the server
+///
+/// @section changelog Change Log
+/// 2026/10/18 ARC lab created
+///
+/// @section license_section License
+/// Copyright (c) 2024-2026, Architecture and Code Optimization Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS  BE LIABLE FOR ANY DIRECT,  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY,  OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS; OR BUSINESS INTERRUPTION)  HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <linux/futex.h>
+
+#include "net.h"
+#include "shm.h"
+
+/// @internal
+#define load(p)      __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define store(p, v)  __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+static void futex_wait(uint32_t *addr, uint32_t val, int ms)
+{
+  struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+  syscall(SYS_futex, addr, FUTEX_WAIT, val, &ts, NULL, 0);
+}
+
+static void futex_wake(uint32_t *addr)
+{
+  syscall(SYS_futex, addr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+/// @brief ring the doorbell of @a r; the wake-up system call is skipped if nobody sleeps
+static void ring_notify(struct shm_ring *r)
+{
+  __atomic_add_fetch(&r->seq, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&r->waiting, __ATOMIC_SEQ_CST)) futex_wake(&r->seq);
+}
+
+/// @brief number of bytes readable (@a rx != 0) or writable (@a rx == 0) in @a r
+static uint32_t ring_avail(struct shm_ring *r, int rx)
+{
+  uint32_t used = load(&r->tail) - load(&r->head);
+  return rx ? used : SHM_RING_SIZE - used;
+}
+
+/// @brief wait until @a r has readable (@a rx != 0) or writable space
+/// @retval 0 on success, -1 if the peer hung up
+static int ring_wait(struct shm_endpoint *ep, struct shm_ring *r, int rx)
+{
+  struct pollfd pfd = { ep->sock, POLLRDHUP, 0 };
+  uint32_t seq;
+
+  while (1) {
+    seq = __atomic_load_n(&r->seq, __ATOMIC_SEQ_CST);
+    if (ring_avail(r, rx) > 0) return 0;
+
+    __atomic_add_fetch(&r->waiting, 1, __ATOMIC_SEQ_CST);
+    if (ring_avail(r, rx) == 0) futex_wait(&r->seq, seq, SHM_WAIT_MS);
+    __atomic_sub_fetch(&r->waiting, 1, __ATOMIC_SEQ_CST);
+
+    if (ring_avail(r, rx) > 0) return 0;
+
+    // nothing happened during the wait slice: check whether the peer is still there
+    if ((poll(&pfd, 1, 0) > 0) && (pfd.revents & (POLLRDHUP | POLLHUP | POLLERR))) return -1;
+  }
+}
+
+static struct shm_endpoint *shm_endpoint(int sock, int memfd, int server)
+{
+  struct shm_endpoint *ep;
+  void *ch;
+
+  ch = mmap(NULL, sizeof(struct shm_channel), PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+  close(memfd);
+  if (ch == MAP_FAILED) {
+    close(sock);
+    return NULL;
+  }
+
+  ep = (struct shm_endpoint *)malloc(sizeof(struct shm_endpoint));
+  ep->sock = sock;
+  ep->ch = (struct shm_channel *)ch;
+  ep->rx = server ? &ep->ch->req : &ep->ch->resp;
+  ep->tx = server ? &ep->ch->resp : &ep->ch->req;
+
+  return ep;
+}
+/// @endinternal
+
+int shm_listen(const char *path)
+{
+  struct sockaddr_un addr;
+  int fd;
+
+  if (strlen(path) >= sizeof(addr.sun_path)) {
+    errno = ENAMETOOLONG;
+    return -1;
+  }
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, path);
+
+  fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) return -1;
+
+  unlink(path);
+  if ((bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) || (listen(fd, 32) < 0)) {
+    close(fd);
+    return -1;
+  }
+
+  return fd;
+}
+
+struct shm_endpoint *shm_accept(int listenfd)
+{
+  char cmsgbuf[CMSG_SPACE(sizeof(int))], c = 'M';
+  struct iovec iov = { &c, 1 };
+  struct msghdr msg;
+  struct cmsghdr *cmsg;
+  int sock, memfd;
+
+  sock = accept4(listenfd, NULL, NULL, SOCK_CLOEXEC);
+  if (sock < 0) return NULL;
+
+  // the channel is zero-initialized by ftruncate()
+  memfd = memfd_create("mcdonalds-shm", MFD_CLOEXEC);
+  if ((memfd < 0) || (ftruncate(memfd, sizeof(struct shm_channel)) < 0)) goto err;
+
+  memset(&msg, 0, sizeof(msg));
+  memset(cmsgbuf, 0, sizeof(cmsgbuf));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = cmsgbuf;
+  msg.msg_controllen = sizeof(cmsgbuf);
+  cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+  memcpy(CMSG_DATA(cmsg), &memfd, sizeof(int));
+
+  if (sendmsg(sock, &msg, MSG_NOSIGNAL) != 1) goto err;
+
+  return shm_endpoint(sock, memfd, 1);
+
+err:
+  if (memfd >= 0) close(memfd);
+  close(sock);
+  return NULL;
+}
+
+struct shm_endpoint *shm_connect(const char *path)
+{
+  char cmsgbuf[CMSG_SPACE(sizeof(int))], c;
+  struct iovec iov = { &c, 1 };
+  struct sockaddr_un addr;
+  struct msghdr msg;
+  struct cmsghdr *cmsg;
+  int sock, memfd;
+
+  if (strlen(path) >= sizeof(addr.sun_path)) return NULL;
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, path);
+
+  sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (sock < 0) return NULL;
+  if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) goto err;
+
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = cmsgbuf;
+  msg.msg_controllen = sizeof(cmsgbuf);
+
+  if (recvmsg(sock, &msg, MSG_CMSG_CLOEXEC) != 1) goto err;
+
+  cmsg = CMSG_FIRSTHDR(&msg);
+  if ((cmsg == NULL) || (cmsg->cmsg_type != SCM_RIGHTS)) goto err;
+  memcpy(&memfd, CMSG_DATA(cmsg), sizeof(int));
+
+  return shm_endpoint(sock, memfd, 0);
+
+err:
+  close(sock);
+  return NULL;
+}
+
+void shm_close(struct shm_endpoint *ep)
+{
+  munmap(ep->ch, sizeof(struct shm_channel));
+  close(ep->sock);
+  free(ep);
+}
+
+int shm_get_line(struct shm_endpoint *ep, char **buf, size_t *cur_len)
+{
+  struct shm_ring *r = ep->rx;
+  uint32_t head, tail;
+  size_t pos = 0;
+  char c = '\0';
+
+  if (*cur_len == 0) return -2;
+
+  // read to first newline ('\n') or hangup
+  while (c != '\n') {
+    if (ring_wait(ep, r, 1) < 0) break;
+
+    head = r->head;
+    tail = load(&r->tail);
+    while ((head != tail) && (c != '\n')) {
+      c = r->data[head++ % SHM_RING_SIZE];
+      (*buf)[pos++] = c;
+
+      // allocate more memory for buf if necessary
+      if (pos == *cur_len) *buf = buf_grow(*buf, cur_len);
+    }
+    store(&r->head, head);
+    ring_notify(r);
+  }
+
+  // null-terminate string
+  (*buf)[pos] = '\0';
+
+  return c == '\n' ? (int)pos : 0;
+}
+
+int shm_put_line(struct shm_endpoint *ep, char *buf, size_t len)
+{
+  struct shm_ring *r = ep->tx;
+  uint32_t tail, n, i;
+  size_t pos = 0, sent = 0;
+  int newline;
+
+  if (len == 0) return -2;
+
+  // find end of string (terminating '\0') and append '\n' if the string isn't ended by it
+  while ((pos < len) && (buf[pos] != '\0')) pos++;
+  newline = (pos == 0) || (buf[pos-1] != '\n');
+
+  while (sent < pos + newline) {
+    if (ring_wait(ep, r, 0) < 0) return -1;
+
+    tail = r->tail;
+    n = ring_avail(r, 0);
+    for (i = 0; (i < n) && (sent < pos + newline); i++, sent++) {
+      r->data[tail++ % SHM_RING_SIZE] = sent < pos ? buf[sent] : '\n';
+    }
+    store(&r->tail, tail);
+    ring_notify(r);
+  }
+
+  // return number of bytes sent (including terminating newline)
+  return (int)sent;
+}
@@ -0,0 +1,113 @@
+//--------------------------------------------------------------------------------------------------
+// Network Lab                             Spring 2024                           System Programming
+//
+/// @file  shm.h
+/// @brief shared-memory transport for clients running on the same host as the server
+///
+/// @section changelog Change Log
+/// 2026/10/18 ARC lab created
+///
+/// @section license_section License
+/// Copyright (c) 2024-2026, Architecture and Code Optimization Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS  BE LIABLE FOR ANY DIRECT,  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY,  OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS; OR BUSINESS INTERRUPTION)  HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#ifndef __SHM_H__
+#define __SHM_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+/// @name Constant definitions
+/// @{
+
+#define SHM_RING_SIZE 4096                                  ///< bytes per ring (power of two)
+#define SHM_WAIT_MS 100                                     ///< futex wait between hangup checks
+
+/// @}
+
+/// @name Structures
+/// @{
+
+/// @brief single-producer/single-consumer byte ring in shared memory. Positions increase
+///        monotonically and are taken modulo SHM_RING_SIZE.
+struct shm_ring {
+  uint32_t head;                                            ///< consumer position
+  uint32_t tail;                                            ///< producer position
+  uint32_t seq;                                             ///< futex doorbell, bumped per update
+  uint32_t waiting;                                         ///< number of peers sleeping on seq
+  char data[SHM_RING_SIZE];                                 ///< ring buffer
+};
+
+/// @brief shared-memory channel of one client connection
+struct shm_channel {
+  struct shm_ring req;                                      ///< requests: client -> server
+  struct shm_ring resp;                                     ///< responses: server -> client
+};
+
+/// @brief one side of a shared-memory connection
+struct shm_endpoint {
+  int sock;                                                 ///< Unix socket (negotiation, hangup)
+  struct shm_channel *ch;                                   ///< mapped channel
+  struct shm_ring *rx;                                      ///< ring this side reads from
+  struct shm_ring *tx;                                      ///< ring this side writes to
+};
+
+/// @}
+
+/// @name connection setup
+/// @{
+
+/// @brief create a Unix socket listening at @a path for shared-memory clients.
+/// @param path socket path (an existing file is replaced)
+/// @retval >=0 listening socket
+/// @retval -1 error, errno contains error code
+int shm_listen(const char *path);
+
+/// @brief accept a client on @a listenfd, create its channel and pass it over the socket.
+/// @param listenfd socket returned by shm_listen()
+/// @retval endpoint of the server side (release with shm_close())
+/// @retval NULL on error
+struct shm_endpoint *shm_accept(int listenfd);
+
+/// @brief connect to the server at @a path and map the channel it passes back.
+/// @param path socket path
+/// @retval endpoint of the client side (release with shm_close())
+/// @retval NULL on error
+struct shm_endpoint *shm_connect(const char *path);
+
+/// @brief unmap the channel and close the Unix socket; the peer sees a hangup.
+/// @param ep endpoint
+void shm_close(struct shm_endpoint *ep);
+
+/// @}
+
+/// @name sending/receiving of '\n'-terminated strings
+/// Same semantics as get_line() and put_line() in net.h.
+/// @{
+
+int shm_get_line(struct shm_endpoint *ep, char **buf, size_t *cur_len);
+int shm_put_line(struct shm_endpoint *ep, char *buf, size_t len);
+
+/// @}
+
+#endif // __SHM_H__
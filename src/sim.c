@@ -0,0 +1,491 @@
+//--------------------------------------------------------------------------------------------------
+// Network Lab                             Spring 2024                           System Programming
+//
+/// @file  sim.c
+/// @brief discrete-event simulation of the server core on a virtual clock
+///
+/// @section changelog Change Log
+/// 2026/10/18 ARC lab created
+///
+/// @section license_section License
+/// Copyright (c) 2024-2026, Architecture and Code Optimization Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS  BE LIABLE FOR ANY DIRECT,  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY,  OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS; OR BUSINESS INTERRUPTION)  HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <math.h>
+#include <time.h>
+
+#include <unistd.h>
+
+#include "request.h"
+#include "trace.h"
+#include "burger.h"
+
+/// @name Constant definitions
+/// @{
+
+#define SIM_IDLE_SEC 2                                      ///< idle sleep of kitchen_task()
+#define SIM_REQUESTS_DEFAULT 1000                           ///< simulated requests
+#define SIM_RATE_DEFAULT 2.0                                ///< default arrival rate (requests/s)
+
+/// @}
+
+/// @name Server core (mcdonalds.c built with MCDONALDS_SIM)
+/// @{
+
+typedef struct __node Node;
+
+extern uint64_t sim_clock;
+extern unsigned int kitchen_count;
+extern bool kitchen_log;
+
+void init_server_ctx(void);
+void print_statistics(void);
+Node** issue_orders(unsigned int customerID, enum burger_type *types, unsigned int burger_count,
+                    unsigned int deadline_ms, void *notify);
+void sim_set_cook_ns(enum burger_type type, uint64_t ns);
+unsigned int sim_admit(void);
+Node* sim_get_order(unsigned int *customerID, enum burger_type *type);
+bool sim_complete_order(Node *order);
+void sim_depart(Node **order_list, unsigned int burger_count, uint64_t start);
+
+/// @}
+
+/// @name Structures
+/// @{
+
+/// @brief distribution of the cooking time of one burger type
+struct cook_time {
+  enum { COOK_CONST, COOK_UNIFORM, COOK_EXP } dist;        ///< distribution
+  double a;                                                 ///< ms: time, min (uniform), mean (exp)
+  double b;                                                 ///< ms: max (uniform)
+};
+
+/// @brief arrival process of synthetic requests
+struct arrivals {
+  enum { ARRIVE_POISSON, ARRIVE_FIXED } process;            ///< interarrival distribution
+  double rate;                                              ///< mean arrival rate (requests/s)
+};
+
+/// @brief simulated event, ordered by time and then by creation
+struct sim_event {
+  uint64_t at;                                              ///< virtual time (ns)
+  unsigned long seq;                                        ///< creation order, breaks ties
+  enum { EVENT_ARRIVAL, EVENT_KITCHEN } kind;               ///< customer arrives, kitchen wakes up
+  unsigned int id;                                          ///< kitchen (EVENT_KITCHEN)
+};
+
+/// @brief simulated kitchen thread
+struct sim_kitchen {
+  Node *order;                                              ///< order cooked or waited for, or NULL
+  unsigned int customerID;                                  ///< customer of @a order
+  enum burger_type type;                                    ///< burger type of @a order
+  uint64_t since;                                           ///< start of the current cook
+  uint64_t busy_ns;                                         ///< total time spent cooking
+};
+
+/// @brief simulated request of an admitted customer
+struct sim_request {
+  Node **orders;                                            ///< issued orders
+  unsigned int burger_count;                                ///< number of orders
+  uint64_t start;                                           ///< arrival time (ns)
+};
+
+/// @}
+
+/// @name Simulation state
+/// @{
+
+static struct cook_time cook[BURGER_TYPE_MAX];              ///< cooking time by burger type
+static struct arrivals arrival = { ARRIVE_POISSON, SIM_RATE_DEFAULT };
+static unsigned short rng[3];                               ///< erand48() state
+static struct sim_event *events;                            ///< event heap
+static unsigned int nevents, events_capacity;               ///< events in / size of the heap
+static unsigned long event_seq;                             ///< next event sequence number
+static struct sim_kitchen *kitchens;                        ///< simulated kitchens
+static struct sim_request *requests;                        ///< requests by customer ID
+static double *latency;                                     ///< latencies of served requests (ms)
+static unsigned long served;                                ///< served customers
+static unsigned long refused;                               ///< customers refused at the door
+static unsigned long rejected;                              ///< requests rejected by deadline
+
+/// @}
+
+/// @name Event queue
+/// Binary min-heap of pending events on (time, sequence).
+/// @{
+
+static bool event_before(const struct sim_event *a, const struct sim_event *b)
+{
+  return (a->at < b->at) || ((a->at == b->at) && (a->seq < b->seq));
+}
+
+static void event_push(uint64_t at, int kind, unsigned int id)
+{
+  struct sim_event e = { at, event_seq++, kind, id };
+  unsigned int i = nevents++;
+
+  if (nevents > events_capacity) {
+    events_capacity = events_capacity ? events_capacity * 2 : 64;
+    events = (struct sim_event *)realloc(events, sizeof(*events) * events_capacity);
+  }
+
+  while ((i > 0) && event_before(&e, &events[(i - 1) / 2])) {
+    events[i] = events[(i - 1) / 2];
+    i = (i - 1) / 2;
+  }
+  events[i] = e;
+}
+
+static struct sim_event event_pop(void)
+{
+  struct sim_event top = events[0], last = events[--nevents];
+  unsigned int i = 0, child;
+
+  while ((child = 2 * i + 1) < nevents) {
+    if ((child + 1 < nevents) && event_before(&events[child + 1], &events[child])) child++;
+    if (!event_before(&events[child], &last)) break;
+    events[i] = events[child];
+    i = child;
+  }
+  if (nevents > 0) events[i] = last;
+
+  return top;
+}
+
+/// @}
+
+/// @name Workload
+/// @{
+
+/// @brief uniform random number in [0, 1)
+static double uniform(void)
+{
+  return erand48(rng);
+}
+
+/// @brief draw a cooking time of burger @a type
+/// @retval cooking time in ns
+static uint64_t cook_ns(enum burger_type type)
+{
+  const struct cook_time *c = &cook[type];
+  double ms = c->a;
+
+  if (c->dist == COOK_UNIFORM) ms = c->a + (c->b - c->a) * uniform();
+  else if (c->dist == COOK_EXP) ms = -c->a * log(1.0 - uniform());
+
+  return (uint64_t)(ms * 1e6);
+}
+
+/// @brief mean cooking time of burger @a type
+/// @retval mean cooking time in ns
+static uint64_t cook_mean_ns(enum burger_type type)
+{
+  const struct cook_time *c = &cook[type];
+  double ms = c->a;
+
+  if (c->dist == COOK_UNIFORM) ms = (c->a + c->b) / 2;
+
+  return (uint64_t)(ms * 1e6);
+}
+
+/// @brief draw the time to the next synthetic arrival
+/// @retval interarrival time in ns
+static uint64_t interarrival_ns(void)
+{
+  if (arrival.process == ARRIVE_FIXED) return (uint64_t)(1e9 / arrival.rate);
+  return (uint64_t)(-log(1.0 - uniform()) / arrival.rate * 1e9);
+}
+
+/// @brief parse cooking times "burger:dist:ms[:ms],...". `burger` is a burger name or `all`,
+///        `dist` is `const:<ms>`, `uniform:<min>:<max>` or `exp:<mean>`.
+/// @retval 0 on success
+/// @retval -1 if @a spec is malformed
+static int parse_cook(const char *spec)
+{
+  char *copy = strdup(spec), *save, *item, *name, *dist, *a, *b;
+  struct cook_time c;
+  int type, i, res = 0;
+
+  for (item = strtok_r(copy, ",", &save); (item != NULL) && (res == 0);
+       item = strtok_r(NULL, ",", &save)) {
+    name = strsep(&item, ":");
+    dist = strsep(&item, ":");
+    a = strsep(&item, ":");
+    b = strsep(&item, ":");
+    if ((dist == NULL) || (a == NULL)) {
+      res = -1;
+      break;
+    }
+
+    c.a = atof(a);
+    c.b = (b != NULL) ? atof(b) : c.a;
+    if (strcmp(dist, "const") == 0) c.dist = COOK_CONST;
+    else if (strcmp(dist, "uniform") == 0) c.dist = COOK_UNIFORM;
+    else if (strcmp(dist, "exp") == 0) c.dist = COOK_EXP;
+    else res = -1;
+    if ((c.a < 0) || (c.b < c.a) || ((c.dist == COOK_UNIFORM) != (b != NULL))) res = -1;
+
+    if (strcmp(name, "all") == 0) {
+      for (i = 0; i < BURGER_TYPE_MAX; i++) cook[i] = c;
+    } else if ((type = burger_lookup(name, strlen(name))) >= 0) {
+      cook[type] = c;
+    } else {
+      res = -1;
+    }
+  }
+
+  free(copy);
+  return res;
+}
+
+/// @brief parse an arrival process "poisson:<rate>" or "fixed:<rate>" (requests per second)
+/// @retval 0 on success
+/// @retval -1 if @a spec is malformed
+static int parse_arrivals(const char *spec)
+{
+  const char *rate = strchr(spec, ':');
+
+  if ((rate == NULL) || ((arrival.rate = atof(rate + 1)) <= 0)) return -1;
+  if (strncmp(spec, "poisson:", 8) == 0) arrival.process = ARRIVE_POISSON;
+  else if (strncmp(spec, "fixed:", 6) == 0) arrival.process = ARRIVE_FIXED;
+  else return -1;
+
+  return 0;
+}
+
+/// @}
+
+/// @name Kitchens
+/// The simulated kitchens follow kitchen_task(): poll the OrderList, sleep SIM_IDLE_SEC when it is
+/// empty, and cook without holding the request mutex, so the burgers of one request are made in
+/// parallel. The mutex is only held to record a cooked burger, which takes no virtual time.
+/// @{
+
+/// @brief kitchen @a k wakes up: finish its burger if it was cooking, then take the next order
+static void kitchen_wake(unsigned int k)
+{
+  struct sim_kitchen *kc = &kitchens[k];
+  struct sim_request *r;
+
+  if (kc->order != NULL) {
+    r = &requests[kc->customerID];
+    kc->busy_ns += sim_clock - kc->since;
+
+    if (sim_complete_order(kc->order)) {
+      latency[served++] = (sim_clock - r->start) * 1e-6;
+      sim_depart(r->orders, r->burger_count, r->start);
+    }
+    kc->order = NULL;
+  }
+
+  kc->order = sim_get_order(&kc->customerID, &kc->type);
+  if (kc->order == NULL) {
+    event_push(sim_clock + SIM_IDLE_SEC * 1000000000ULL, EVENT_KITCHEN, k);
+    return;
+  }
+
+  kc->since = sim_clock;
+  event_push(sim_clock + cook_ns(kc->type), EVENT_KITCHEN, k);
+}
+
+/// @}
+
+/// @brief customer @a req arrives at `sim_clock`
+static void customer_arrive(const struct trace_request *req)
+{
+  unsigned int customerID = sim_admit();
+  struct sim_request *r;
+  Node **orders;
+
+  if (customerID == UINT_MAX) {
+    refused++;
+    return;
+  }
+
+  orders = issue_orders(customerID, req->types, req->burger_count, req->deadline_ms, NULL);
+  if (orders == NULL) {
+    rejected++;
+    sim_depart(NULL, 0, sim_clock);
+    return;
+  }
+
+  r = &requests[customerID];
+  r->orders = orders;
+  r->burger_count = req->burger_count;
+  r->start = sim_clock;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+  double x = *(const double *)a, y = *(const double *)b;
+
+  return (x > y) - (x < y);
+}
+
+/// @brief print the usage
+static void usage(void)
+{
+  printf("usage ./mcsim [-a poisson:rate|fixed:rate] [-c burger:dist:ms[:ms],...] "
+         "[-d deadline_ms] [-k kitchens] [-n burgers] [-s seed] [requests]\n"
+         "      ./mcsim -r trace [-c burger:dist:ms[:ms],...] [-k kitchens] [max_requests]\n");
+}
+
+/// @brief program entry point
+int main(int argc, char *argv[])
+{
+  struct trace_request *trace = NULL, synthetic;
+  const char *replay_path = NULL;
+  unsigned int deadline_ms = 0, burgers = MAX_BURGERS, seed = 1, i;
+  size_t count = SIM_REQUESTS_DEFAULT, total = 0, next = 0;
+  struct timespec wall_start, wall_end;
+  struct sim_event e;
+  uint64_t busy = 0;
+  long limit = -1;
+  int opt;
+
+  for (i = 0; i < BURGER_TYPE_MAX; i++) cook[i] = (struct cook_time){ COOK_CONST, 1000, 1000 };
+
+  while ((opt = getopt(argc, argv, "a:c:d:k:n:r:s:")) != -1) {
+    if (opt == 'a') {
+      if (parse_arrivals(optarg) < 0) {
+        printf("invalid arrival process '%s'\n", optarg);
+        return EXIT_FAILURE;
+      }
+    }
+    else if (opt == 'c') {
+      if (parse_cook(optarg) < 0) {
+        printf("invalid cooking times '%s'\n", optarg);
+        return EXIT_FAILURE;
+      }
+    }
+    else if (opt == 'd') deadline_ms = atoi(optarg);
+    else if (opt == 'k') kitchen_count = atoi(optarg);
+    else if (opt == 'n') burgers = atoi(optarg);
+    else if (opt == 'r') replay_path = optarg;
+    else if (opt == 's') seed = strtoul(optarg, NULL, 0);
+    else {
+      usage();
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (argc - optind == 1) limit = atol(argv[optind]);
+  if ((argc - optind > 1) || (limit == 0) || (kitchen_count == 0) ||
+      (burgers == 0)) {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  if (replay_path != NULL) {
+    trace = trace_load(replay_path, &total);
+    if (trace == NULL) {
+      perror(replay_path);
+      return EXIT_FAILURE;
+    }
+    count = ((limit > 0) && ((size_t)limit < total)) ? (size_t)limit : total;
+  } else if (limit > 0) {
+    count = limit;
+  }
+
+  rng[0] = 0x330e;
+  rng[1] = seed & 0xffff;
+  rng[2] = seed >> 16;
+  synthetic.types = (enum burger_type *)malloc(sizeof(enum burger_type) * burgers);
+
+  kitchen_log = false;
+  init_server_ctx();
+  // deadline admission estimates with the configured cook times instead of make_burger()'s
+  for (i = 0; i < BURGER_TYPE_MAX; i++) sim_set_cook_ns(i, cook_mean_ns(i));
+
+  kitchens = (struct sim_kitchen *)calloc(kitchen_count, sizeof(struct sim_kitchen));
+  requests = (struct sim_request *)calloc(count ? count : 1, sizeof(struct sim_request));
+  latency = (double *)malloc(sizeof(double) * (count ? count : 1));
+
+  clock_gettime(CLOCK_MONOTONIC, &wall_start);
+
+  // kitchen threads start polling right away; the first customer arrives after one interarrival
+  for (i = 0; i < kitchen_count; i++) event_push(0, EVENT_KITCHEN, i);
+  if (count > 0) event_push(trace != NULL ? 0 : interarrival_ns(), EVENT_ARRIVAL, 0);
+
+  // run until every customer has arrived and left
+  while (nevents > 0) {
+    e = event_pop();
+    sim_clock = e.at;
+
+    if (e.kind == EVENT_KITCHEN) {
+      kitchen_wake(e.id);
+    } else if (trace != NULL) {
+      customer_arrive(&trace[next]);
+      if (++next < count) event_push(trace[next].at - trace[0].at, EVENT_ARRIVAL, 0);
+    } else {
+      synthetic.burger_count = BURGER_NUM_RAND ? (unsigned int)(uniform() * burgers) + 1 : burgers;
+      for (i = 0; i < synthetic.burger_count; i++) {
+        synthetic.types[i] = (enum burger_type)(uniform() * BURGER_TYPE_MAX);
+      }
+      synthetic.deadline_ms = deadline_ms;
+      customer_arrive(&synthetic);
+      if (++next < count) event_push(sim_clock + interarrival_ns(), EVENT_ARRIVAL, 0);
+    }
+
+    if ((next == count) && (served + refused + rejected == count)) break;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &wall_end);
+
+  for (i = 0; i < kitchen_count; i++) {
+    busy += kitchens[i].busy_ns;
+  }
+  qsort(latency, served, sizeof(double), compare_double);
+
+  printf("Simulated %zu customers in %.3f s of virtual time (%.3f s wall time)\n", count,
+         sim_clock * 1e-9, (wall_end.tv_sec - wall_start.tv_sec) +
+                           (wall_end.tv_nsec - wall_start.tv_nsec) * 1e-9);
+  printf("Served %lu, refused %lu at the door, rejected %lu by deadline\n", served, refused,
+         rejected);
+  if (served > 0) {
+    printf("Latency: p50 %.1f ms, p90 %.1f ms, p99 %.1f ms, max %.1f ms\n",
+           latency[served / 2], latency[served * 9 / 10], latency[served * 99 / 100],
+           latency[served - 1]);
+  }
+  if (sim_clock > 0) {
+    printf("Kitchens: %u, %.1f%% cooking\n", kitchen_count,
+           100.0 * busy / ((double)sim_clock * kitchen_count));
+  }
+  print_statistics();
+
+  if (trace != NULL) trace_free(trace, total);
+  free(synthetic.types);
+  free(latency);
+  free(requests);
+  free(kitchens);
+  free(events);
+
+  return EXIT_SUCCESS;
+}
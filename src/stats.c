@@ -0,0 +1,151 @@
+//--------------------------------------------------------------------------------------------------
+// Network Lab                             Spring 2024                           System Programming
+//
+/// @file  stats.c
+/// @brief server statistics published in a memory-mapped file and protected by a seqlock
+///
+/// @section changelog Change Log
+/// 2026/10/18 ARC lab created
+///
+/// @section license_section License
+/// Copyright (c) 2024-2026, Architecture and Code Optimization Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS  BE LIABLE FOR ANY DIRECT,  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY,  OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS; OR BUSINESS INTERRUPTION)  HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "stats.h"
+
+/// @internal
+#if defined(__x86_64__) || defined(__i386__)
+#define cpu_relax() __builtin_ia32_pause()
+#else
+#define cpu_relax() do { } while (0)
+#endif
+
+#define STATS_COUNTERS ((sizeof(struct stats_page) - offsetof(struct stats_page, customers)) / \
+                        sizeof(uint64_t))
+
+static uint64_t *counters(const struct stats_page *page)
+{
+  return (uint64_t *)&page->customers;
+}
+/// @endinternal
+
+struct stats_page *stats_create(const char *path)
+{
+  struct stats_page *page;
+  int fd;
+
+  fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) return NULL;
+  if (ftruncate(fd, sizeof(struct stats_page)) < 0) {
+    close(fd);
+    return NULL;
+  }
+
+  page = (struct stats_page *)mmap(NULL, sizeof(struct stats_page), PROT_READ | PROT_WRITE,
+                                   MAP_SHARED, fd, 0);
+  close(fd);
+  if (page == MAP_FAILED) return NULL;
+
+  __atomic_store_n(&page->magic, STATS_MAGIC, __ATOMIC_RELEASE);
+  return page;
+}
+
+const struct stats_page *stats_open(const char *path)
+{
+  const struct stats_page *page;
+  struct stat st;
+  int fd;
+
+  fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return NULL;
+  if ((fstat(fd, &st) < 0) || (st.st_size < sizeof(struct stats_page))) {
+    close(fd);
+    errno = EINVAL;
+    return NULL;
+  }
+
+  page = (const struct stats_page *)mmap(NULL, sizeof(struct stats_page), PROT_READ, MAP_SHARED,
+                                         fd, 0);
+  close(fd);
+  if (page == MAP_FAILED) return NULL;
+
+  if (__atomic_load_n(&page->magic, __ATOMIC_ACQUIRE) != STATS_MAGIC) {
+    munmap((void *)page, sizeof(struct stats_page));
+    errno = EINVAL;
+    return NULL;
+  }
+  return page;
+}
+
+void stats_publish(struct stats_page *page, const struct stats_page *src)
+{
+  uint64_t *dst = counters(page);
+  const uint64_t *s = counters(src);
+  uint32_t seq = page->seq;
+  unsigned int i;
+
+  // odd sequence: readers that overlap this update will retry
+  __atomic_store_n(&page->seq, seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  for (i = 0; i < STATS_COUNTERS; i++) __atomic_store_n(&dst[i], s[i], __ATOMIC_RELAXED);
+
+  __atomic_store_n(&page->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+void stats_snapshot(const struct stats_page *page, struct stats_page *dst)
+{
+  const uint64_t *src = counters(page);
+  uint64_t *d = counters(dst);
+  uint32_t seq;
+  unsigned int i;
+
+  do {
+    while ((seq = __atomic_load_n(&page->seq, __ATOMIC_ACQUIRE)) & 1) cpu_relax();
+
+    for (i = 0; i < STATS_COUNTERS; i++) d[i] = __atomic_load_n(&src[i], __ATOMIC_RELAXED);
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  } while (__atomic_load_n(&page->seq, __ATOMIC_RELAXED) != seq);
+
+  dst->magic = STATS_MAGIC;
+  dst->seq = seq;
+}
+
+unsigned int stats_latency_bucket(double ms)
+{
+  unsigned int b = 0;
+
+  while ((b < STATS_LATENCY_BUCKETS - 1) && (ms >= (double)(1u << b))) b++;
+  return b;
+}
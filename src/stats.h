@@ -0,0 +1,96 @@
+//--------------------------------------------------------------------------------------------------
+// Network Lab                             Spring 2024                           System Programming
+//
+/// @file  stats.h
+/// @brief server statistics published in a memory-mapped file and protected by a seqlock
+///
+/// @section changelog Change Log
+/// 2026/10/18 ARC lab created
+///
+/// @section license_section License
+/// Copyright (c) 2024-2026, Architecture and Code Optimization Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS  BE LIABLE FOR ANY DIRECT,  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY,  OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS; OR BUSINESS INTERRUPTION)  HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#ifndef __STATS_H__
+#define __STATS_H__
+
+#include <stdint.h>
+
+#include "burger.h"
+
+/// @name Constant definitions
+/// @{
+
+#define STATS_MAGIC 0x5453434d                              ///< "MCST"
+/// latency buckets: bucket 0 holds <1 ms, bucket i <2^i ms, and the last one >=2^14 ms
+#define STATS_LATENCY_BUCKETS 16                            ///< number of latency buckets
+
+/// @}
+
+/// @brief statistics page shared between the server and readers. The server is the only writer
+///        (updates are serialized by its context lock); readers retry while @a seq is odd or has
+///        changed during their copy, so the server never waits for them.
+struct stats_page {
+  uint32_t magic;                                           ///< STATS_MAGIC once initialized
+  uint32_t seq;                                             ///< seqlock sequence, odd while writing
+  uint64_t customers;                                       ///< customers visited
+  uint64_t burgers[BURGER_TYPE_MAX];                        ///< burgers made by type
+  uint64_t queue;                                           ///< orders waiting in the OrderList
+  uint64_t inflight;                                        ///< customers being served
+  uint64_t latency[STATS_LATENCY_BUCKETS];                  ///< served requests by latency bucket
+  uint64_t cancelled;                                       ///< requests cancelled on hangup
+  uint64_t saved;                                           ///< burgers not cooked due to hangups
+  uint64_t wasted;                                          ///< burgers cooked for departed ones
+};
+
+/// @name statistics page access
+/// @{
+
+/// @brief create (or truncate) the statistics file at @a path and map it writable.
+/// @param path statistics file
+/// @retval mapped page
+/// @retval NULL error, errno contains error code
+struct stats_page *stats_create(const char *path);
+
+/// @brief map the statistics file at @a path read-only.
+/// @param path statistics file
+/// @retval mapped page
+/// @retval NULL error, errno contains error code (EINVAL if the file is not a statistics file)
+const struct stats_page *stats_open(const char *path);
+
+/// @brief publish the counters of @a src in @a page. Callers must be serialized.
+/// @param page mapped page
+/// @param src new counter values (magic and seq are ignored)
+void stats_publish(struct stats_page *page, const struct stats_page *src);
+
+/// @brief take a consistent snapshot of @a page without blocking the writer.
+/// @param page mapped page
+/// @param dst snapshot. Out parameter.
+void stats_snapshot(const struct stats_page *page, struct stats_page *dst);
+
+/// @brief latency bucket of a request that took @a ms milliseconds
+unsigned int stats_latency_bucket(double ms);
+
+/// @}
+
+#endif // __STATS_H__
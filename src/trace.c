@@ -0,0 +1,169 @@
+//--------------------------------------------------------------------------------------------------
+// Network Lab                             Spring 2024                           System Programming
+//
+/// @file  trace.c
+/// @brief binary arrival traces: recorded by the server, replayed by the client
+///
+/// @section changelog Change Log
+/// 2026/10/18 ARC lab created
+///
+/// @section license_section License
+/// Copyright (c) 2024-2026, Architecture and Code Optimization Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS  BE LIABLE FOR ANY DIRECT,  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY,  OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS; OR BUSINESS INTERRUPTION)  HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include "trace.h"
+
+LOCKSTAT_CLASS(trace);                                      ///< `lock` of the trace writer
+
+/// @internal
+static const char trace_magic[16] = "MCDTRACE1";          ///< file header
+
+/// @brief on-disk record, followed by @a burger_count one-byte burger types
+struct trace_record {
+  uint64_t at;                                              ///< arrival, ns after trace start
+  uint32_t deadline_ms;                                     ///< requested deadline (0: none)
+  uint32_t burger_count;                                    ///< number of burger types
+};
+
+static uint64_t now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int trace_cmp(const void *a, const void *b)
+{
+  const struct trace_request *x = (const struct trace_request *)a;
+  const struct trace_request *y = (const struct trace_request *)b;
+
+  return (x->at > y->at) - (x->at < y->at);
+}
+/// @endinternal
+
+int trace_create(struct trace_writer *w, const char *path)
+{
+  w->f = fopen(path, "w");
+  if (w->f == NULL) return -1;
+
+  if (fwrite(trace_magic, sizeof(trace_magic), 1, w->f) != 1) {
+    fclose(w->f);
+    return -1;
+  }
+
+  lockstat_init(&w->lock, trace);
+  w->start = now_ns();
+  w->records = 0;
+  return 0;
+}
+
+void trace_append(struct trace_writer *w, uint64_t arrival, const enum burger_type *types,
+                  unsigned int burger_count, unsigned int deadline_ms)
+{
+  struct trace_record r;
+  uint8_t t;
+
+  r.at = arrival > w->start ? arrival - w->start : 0;
+  r.deadline_ms = deadline_ms;
+  r.burger_count = burger_count;
+
+  lockstat_lock(&w->lock);
+  fwrite(&r, sizeof(r), 1, w->f);
+  for (unsigned int i = 0; i < burger_count; i++) {
+    t = types[i];
+    fputc(t, w->f);
+  }
+  w->records++;
+  lockstat_unlock(&w->lock);
+}
+
+void trace_flush(struct trace_writer *w)
+{
+  lockstat_lock(&w->lock);
+  fflush(w->f);
+  lockstat_unlock(&w->lock);
+}
+
+struct trace_request *trace_load(const char *path, size_t *count)
+{
+  struct trace_request *reqs = NULL, *q;
+  struct trace_record r;
+  size_t n = 0, capacity = 0;
+  char magic[sizeof(trace_magic)];
+  int c;
+  FILE *f;
+
+  f = fopen(path, "r");
+  if (f == NULL) return NULL;
+
+  if ((fread(magic, sizeof(magic), 1, f) != 1) ||
+      (memcmp(magic, trace_magic, sizeof(magic)) != 0)) {
+    fclose(f);
+    errno = EINVAL;
+    return NULL;
+  }
+
+  while (fread(&r, sizeof(r), 1, f) == 1) {
+    if (n == capacity) {
+      capacity = capacity ? capacity * 2 : 256;
+      reqs = (struct trace_request *)realloc(reqs, sizeof(struct trace_request) * capacity);
+    }
+    q = &reqs[n];
+    q->at = r.at;
+    q->deadline_ms = r.deadline_ms;
+    q->burger_count = r.burger_count;
+    q->types = (enum burger_type *)malloc(sizeof(enum burger_type) * (r.burger_count + 1));
+    n++;
+
+    for (unsigned int i = 0; i < r.burger_count; i++) {
+      c = fgetc(f);
+      if ((c == EOF) || (c >= BURGER_TYPE_MAX)) {
+        trace_free(reqs, n);
+        fclose(f);
+        errno = EINVAL;
+        return NULL;
+      }
+      q->types[i] = (enum burger_type)c;
+    }
+  }
+  fclose(f);
+
+  // requests are recorded when parsed, so concurrent customers may be slightly out of order
+  qsort(reqs, n, sizeof(struct trace_request), trace_cmp);
+
+  *count = n;
+  return reqs != NULL ? reqs : (struct trace_request *)calloc(1, sizeof(struct trace_request));
+}
+
+void trace_free(struct trace_request *reqs, size_t count)
+{
+  for (size_t i = 0; i < count; i++) free(reqs[i].types);
+  free(reqs);
+}
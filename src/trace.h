@@ -0,0 +1,105 @@
+//--------------------------------------------------------------------------------------------------
+// Network Lab                             Spring 2024                           System Programming
+//
+/// @file  trace.h
+/// @brief binary arrival traces: recorded by the server, replayed by the client
+///
+/// @section changelog Change Log
+/// 2026/10/18 ARC lab created
+///
+/// @section license_section License
+/// Copyright (c) 2024-2026, Architecture and Code Optimization Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS  BE LIABLE FOR ANY DIRECT,  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY,  OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS; OR BUSINESS INTERRUPTION)  HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "burger.h"
+#include "lockstat.h"
+
+/// @name Structures
+/// @{
+
+/// @brief trace being recorded. Records are appended under @a lock through a stdio buffer, so
+///        recording costs no system call per request.
+struct trace_writer {
+  FILE *f;                                                  ///< trace file
+  lockstat_mutex_t lock;                                    ///< serializes appends
+  uint64_t start;                                           ///< CLOCK_MONOTONIC at creation (ns)
+  unsigned long records;                                    ///< number of recorded requests
+};
+
+/// @brief one request of a loaded trace
+struct trace_request {
+  uint64_t at;                                              ///< arrival, ns after trace start
+  unsigned int deadline_ms;                                 ///< requested deadline (0: none)
+  unsigned int burger_count;                                ///< number of burgers
+  enum burger_type *types;                                  ///< requested burgers
+};
+
+/// @}
+
+/// @name trace operations
+/// @{
+
+/// @brief create (truncate) the trace file @a path and write its header
+/// @param w writer to initialize
+/// @param path trace file
+/// @retval 0 on success
+/// @retval -1 error, errno contains error code
+int trace_create(struct trace_writer *w, const char *path);
+
+/// @brief append one request
+/// @param w writer
+/// @param arrival CLOCK_MONOTONIC time the customer arrived (ns)
+/// @param types burger types
+/// @param burger_count number of entries in @a types
+/// @param deadline_ms requested deadline (0: none)
+void trace_append(struct trace_writer *w, uint64_t arrival, const enum burger_type *types,
+                  unsigned int burger_count, unsigned int deadline_ms);
+
+/// @brief flush buffered records to the file (the writer stays usable)
+/// @param w writer
+void trace_flush(struct trace_writer *w);
+
+/// @brief load all requests of the trace at @a path, ordered by arrival. Free with trace_free().
+/// @param path trace file
+/// @param count number of requests. Out parameter.
+/// @retval array of @a count requests
+/// @retval NULL error, errno contains error code (EINVAL: not a trace or truncated)
+struct trace_request *trace_load(const char *path, size_t *count);
+
+/// @brief free a trace returned by trace_load()
+/// @param reqs requests
+/// @param count number of requests
+void trace_free(struct trace_request *reqs, size_t count);
+
+/// @}
+
+#endif // __TRACE_H__
@@ -0,0 +1,258 @@
+//--------------------------------------------------------------------------------------------------
+// Network Lab                             Spring 2024                           System Programming
+//
+/// @file  uring.c
+/// @brief minimal io_uring wrapper on top of the raw system calls (no liburing dependency)
+///
+/// @section changelog Change Log
+/// 2026/10/18 ARC lab created
+///
+/// @section license_section License
+/// Copyright (c) 2024-2026, Architecture and Code Optimization Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS  BE LIABLE FOR ANY DIRECT,  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY,  OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS; OR BUSINESS INTERRUPTION)  HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+
+#include "uring.h"
+
+/// @internal
+#define uring_load_acquire(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define uring_store_release(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+static int sys_io_uring_setup(unsigned entries, struct io_uring_params *p)
+{
+  return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+  return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+/// @endinternal
+
+int uring_init(struct uring *ring, unsigned entries)
+{
+  struct io_uring_params p;
+  char *sq, *cq;
+
+  memset(ring, 0, sizeof(*ring));
+  memset(&p, 0, sizeof(p));
+
+  ring->fd = sys_io_uring_setup(entries, &p);
+  if (ring->fd < 0) return -1;
+
+  ring->sq_ring_sz = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  ring->cq_ring_sz = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  ring->sqes_sz = p.sq_entries * sizeof(struct io_uring_sqe);
+
+  // kernels with IORING_FEAT_SINGLE_MMAP share one mapping for both rings
+  if (p.features & IORING_FEAT_SINGLE_MMAP) {
+    if (ring->cq_ring_sz > ring->sq_ring_sz) ring->sq_ring_sz = ring->cq_ring_sz;
+    ring->cq_ring_sz = ring->sq_ring_sz;
+  }
+
+  ring->sq_ring = mmap(NULL, ring->sq_ring_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring->fd, IORING_OFF_SQ_RING);
+  if (ring->sq_ring == MAP_FAILED) goto err_close;
+
+  if (p.features & IORING_FEAT_SINGLE_MMAP) {
+    ring->cq_ring = ring->sq_ring;
+  } else {
+    ring->cq_ring = mmap(NULL, ring->cq_ring_sz, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+    if (ring->cq_ring == MAP_FAILED) goto err_sq;
+  }
+
+  ring->sqes = mmap(NULL, ring->sqes_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    ring->fd, IORING_OFF_SQES);
+  if (ring->sqes == MAP_FAILED) goto err_cq;
+
+  sq = (char *)ring->sq_ring;
+  ring->sq_head    = (unsigned *)(sq + p.sq_off.head);
+  ring->sq_tail    = (unsigned *)(sq + p.sq_off.tail);
+  ring->sq_mask    = (unsigned *)(sq + p.sq_off.ring_mask);
+  ring->sq_array   = (unsigned *)(sq + p.sq_off.array);
+  ring->sq_flags   = (unsigned *)(sq + p.sq_off.flags);
+  ring->sq_entries = p.sq_entries;
+  ring->sqe_tail   = *ring->sq_tail;
+
+  cq = (char *)ring->cq_ring;
+  ring->cq_head     = (unsigned *)(cq + p.cq_off.head);
+  ring->cq_tail     = (unsigned *)(cq + p.cq_off.tail);
+  ring->cq_mask     = (unsigned *)(cq + p.cq_off.ring_mask);
+  ring->cq_overflow = (unsigned *)(cq + p.cq_off.overflow);
+  ring->cqes        = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+  return 0;
+
+err_cq:
+  if (ring->cq_ring != ring->sq_ring) munmap(ring->cq_ring, ring->cq_ring_sz);
+err_sq:
+  munmap(ring->sq_ring, ring->sq_ring_sz);
+err_close:
+  close(ring->fd);
+  ring->fd = -1;
+  return -1;
+}
+
+void uring_exit(struct uring *ring)
+{
+  if (ring->fd < 0) return;
+
+  munmap(ring->sqes, ring->sqes_sz);
+  if (ring->cq_ring != ring->sq_ring) munmap(ring->cq_ring, ring->cq_ring_sz);
+  munmap(ring->sq_ring, ring->sq_ring_sz);
+  close(ring->fd);
+  ring->fd = -1;
+}
+
+struct io_uring_sqe *uring_get_sqe(struct uring *ring)
+{
+  unsigned head = uring_load_acquire(ring->sq_head);
+  struct io_uring_sqe *sqe;
+
+  if (ring->sqe_tail - head >= ring->sq_entries) return NULL;
+
+  sqe = &ring->sqes[ring->sqe_tail & *ring->sq_mask];
+  ring->sq_array[ring->sqe_tail & *ring->sq_mask] = ring->sqe_tail & *ring->sq_mask;
+  ring->sqe_tail++;
+
+  memset(sqe, 0, sizeof(*sqe));
+  return sqe;
+}
+
+int uring_submit_and_wait(struct uring *ring, unsigned wait_nr)
+{
+  unsigned to_submit, flags;
+  int r;
+
+  // publish the new SQEs to the kernel
+  uring_store_release(ring->sq_tail, ring->sqe_tail);
+
+  // with an overflowed CQ the kernel only accepts new SQEs once the backlog has been flushed
+  flags = wait_nr ? IORING_ENTER_GETEVENTS : 0;
+  if (uring_load_acquire(ring->sq_flags) & IORING_SQ_CQ_OVERFLOW) flags |= IORING_ENTER_GETEVENTS;
+
+  // entries the kernel has not consumed yet (e.g., because we were interrupted) are resubmitted
+  do {
+    to_submit = ring->sqe_tail - uring_load_acquire(ring->sq_head);
+    r = sys_io_uring_enter(ring->fd, to_submit, wait_nr, flags);
+  } while ((r < 0) && (errno == EINTR));
+
+  return r;
+}
+
+struct io_uring_cqe *uring_peek_cqe(struct uring *ring)
+{
+  unsigned head = *ring->cq_head;
+
+  if (head == uring_load_acquire(ring->cq_tail)) return NULL;
+  return &ring->cqes[head & *ring->cq_mask];
+}
+
+void uring_cqe_seen(struct uring *ring)
+{
+  uring_store_release(ring->cq_head, *ring->cq_head + 1);
+}
+
+int uring_cq_flush(struct uring *ring)
+{
+  int r;
+
+  if (!(uring_load_acquire(ring->sq_flags) & IORING_SQ_CQ_OVERFLOW)) return 0;
+
+  do {
+    r = sys_io_uring_enter(ring->fd, 0, 0, IORING_ENTER_GETEVENTS);
+  } while ((r < 0) && (errno == EINTR));
+
+  return 1;
+}
+
+unsigned uring_cq_dropped(struct uring *ring)
+{
+  return uring_load_acquire(ring->cq_overflow);
+}
+
+void uring_prep_accept_multishot(struct io_uring_sqe *sqe, int fd, int flags, uint64_t user_data)
+{
+  sqe->opcode = IORING_OP_ACCEPT;
+  sqe->fd = fd;
+  sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+  sqe->accept_flags = flags;
+  sqe->user_data = user_data;
+}
+
+void uring_prep_recv(struct io_uring_sqe *sqe, int fd, void *buf, unsigned len,
+                     uint64_t user_data)
+{
+  sqe->opcode = IORING_OP_RECV;
+  sqe->fd = fd;
+  sqe->addr = (uint64_t)(uintptr_t)buf;
+  sqe->len = len;
+  sqe->user_data = user_data;
+}
+
+void uring_prep_send(struct io_uring_sqe *sqe, int fd, const void *buf, unsigned len,
+                     uint64_t user_data)
+{
+  sqe->opcode = IORING_OP_SEND;
+  sqe->fd = fd;
+  sqe->addr = (uint64_t)(uintptr_t)buf;
+  sqe->len = len;
+  sqe->msg_flags = MSG_NOSIGNAL;
+  sqe->user_data = user_data;
+}
+
+void uring_prep_read(struct io_uring_sqe *sqe, int fd, void *buf, unsigned len,
+                     uint64_t user_data)
+{
+  sqe->opcode = IORING_OP_READ;
+  sqe->fd = fd;
+  sqe->addr = (uint64_t)(uintptr_t)buf;
+  sqe->len = len;
+  sqe->off = (uint64_t)-1;
+  sqe->user_data = user_data;
+}
+
+void uring_prep_poll_add(struct io_uring_sqe *sqe, int fd, unsigned poll_mask, uint64_t user_data)
+{
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = fd;
+  sqe->poll32_events = poll_mask;
+  sqe->user_data = user_data;
+}
+
+void uring_prep_poll_remove(struct io_uring_sqe *sqe, uint64_t target, uint64_t user_data)
+{
+  sqe->opcode = IORING_OP_POLL_REMOVE;
+  sqe->fd = -1;
+  sqe->addr = target;
+  sqe->user_data = user_data;
+}
@@ -0,0 +1,133 @@
+//--------------------------------------------------------------------------------------------------
+// Network Lab                             Spring 2024                           System Programming
+//
+/// @file  uring.h
+/// @brief minimal io_uring wrapper on top of the raw system calls (no liburing dependency)
+///
+/// @section changelog Change Log
+/// 2026/10/18 ARC lab created
+///
+/// @section license_section License
+/// Copyright (c) 2024-2026, Architecture and Code Optimization Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS  BE LIABLE FOR ANY DIRECT,  INDIRECT, INCIDENTAL, SPECIAL,  EXEMPLARY,  OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS; OR BUSINESS INTERRUPTION)  HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#ifndef __URING_H__
+#define __URING_H__
+
+#include <stdint.h>
+#include <linux/io_uring.h>
+
+/// @brief submission and completion rings of one io_uring instance
+struct uring {
+  int fd;                                                   ///< io_uring file descriptor
+  unsigned *sq_head;                                        ///< SQ head (kernel-owned)
+  unsigned *sq_tail;                                        ///< SQ tail (user-owned)
+  unsigned *sq_mask;                                        ///< SQ index mask
+  unsigned *sq_array;                                       ///< SQ index array
+  unsigned *sq_flags;                                       ///< SQ flags (IORING_SQ_CQ_OVERFLOW)
+  unsigned sq_entries;                                      ///< number of SQ entries
+  unsigned sqe_tail;                                        ///< next SQE to hand out
+  struct io_uring_sqe *sqes;                                ///< SQE array
+  unsigned *cq_head;                                        ///< CQ head (user-owned)
+  unsigned *cq_tail;                                        ///< CQ tail (kernel-owned)
+  unsigned *cq_mask;                                        ///< CQ index mask
+  unsigned *cq_overflow;                                    ///< completions dropped by the kernel
+  struct io_uring_cqe *cqes;                                ///< CQE array
+  void *sq_ring, *cq_ring;                                  ///< mapped ring regions
+  size_t sq_ring_sz, cq_ring_sz, sqes_sz;                   ///< sizes of the mapped regions
+};
+
+/// @name ring setup
+/// @{
+
+/// @brief create an io_uring instance with @a entries submission slots and map its rings.
+/// @param ring ring to initialize
+/// @param entries number of SQ entries (power of two)
+/// @retval 0 on success
+/// @retval -1 error, errno contains error code (ENOSYS if io_uring is not available)
+int uring_init(struct uring *ring, unsigned entries);
+
+/// @brief unmap the rings and close the io_uring file descriptor.
+/// @param ring ring to release
+void uring_exit(struct uring *ring);
+
+/// @}
+
+/// @name submission/completion
+/// @{
+
+/// @brief get a zeroed submission queue entry. The entry is submitted with the next call to
+///        uring_submit_and_wait().
+/// @param ring ring
+/// @retval SQE pointer
+/// @retval NULL if the submission queue is full
+struct io_uring_sqe *uring_get_sqe(struct uring *ring);
+
+/// @brief submit all queued SQEs and wait for at least @a wait_nr completions with a single
+///        io_uring_enter() call.
+/// @param ring ring
+/// @param wait_nr number of completions to wait for
+/// @retval >=0 number of submitted SQEs
+/// @retval -1 error, errno contains error code
+int uring_submit_and_wait(struct uring *ring, unsigned wait_nr);
+
+/// @brief return the oldest unconsumed completion, or NULL if the completion queue is empty.
+/// @param ring ring
+/// @retval CQE pointer or NULL
+struct io_uring_cqe *uring_peek_cqe(struct uring *ring);
+
+/// @brief mark the CQE returned by uring_peek_cqe() as consumed.
+/// @param ring ring
+void uring_cqe_seen(struct uring *ring);
+
+/// @brief move completions the kernel held back because the CQ was full (IORING_SQ_CQ_OVERFLOW)
+///        into the CQ. Call after the CQ has been drained.
+/// @param ring ring
+/// @retval 1 overflowed completions were flushed, reap the CQ again
+/// @retval 0 no overflow
+int uring_cq_flush(struct uring *ring);
+
+/// @brief number of completions the kernel dropped because the CQ was full. Stays 0 on kernels
+///        with IORING_FEAT_NODROP unless the kernel runs out of memory.
+/// @param ring ring
+/// @retval number of dropped completions
+unsigned uring_cq_dropped(struct uring *ring);
+
+/// @}
+
+/// @name SQE preparation helpers
+/// @{
+
+void uring_prep_accept_multishot(struct io_uring_sqe *sqe, int fd, int flags, uint64_t user_data);
+void uring_prep_recv(struct io_uring_sqe *sqe, int fd, void *buf, unsigned len,
+                     uint64_t user_data);
+void uring_prep_send(struct io_uring_sqe *sqe, int fd, const void *buf, unsigned len,
+                     uint64_t user_data);
+void uring_prep_read(struct io_uring_sqe *sqe, int fd, void *buf, unsigned len,
+                     uint64_t user_data);
+void uring_prep_poll_add(struct io_uring_sqe *sqe, int fd, unsigned poll_mask, uint64_t user_data);
+void uring_prep_poll_remove(struct io_uring_sqe *sqe, uint64_t target, uint64_t user_data);
+
+/// @}
+
+#endif // __URING_H__